@@ -1,23 +1,120 @@
 #include <display/HoverableListWidget.h>
-#include <finder/Dictionary.h>
 
 #include <QDesktopServices>
 #include <QDir>
 #include <QFileInfo>
-#include <QFontMetrics>
-#include <QMouseEvent>
 #include <QResizeEvent>
-#include <QToolTip>
+#include <QTextCharFormat>
 #include <QUrl>
+#include <algorithm>
 #ifdef Q_OS_WIN
 #include <QProcess>
 #endif
 
-#include <utils/filesystem/filesystem.hpp>
+void RichTextDelegate::watchModel(const QAbstractItemModel *model) {
+  // the cache is keyed by row, any change of the rows makes it stale
+  connect(model, &QAbstractItemModel::modelReset, this, &RichTextDelegate::clearCache);
+  connect(model, &QAbstractItemModel::layoutChanged, this, &RichTextDelegate::clearCache);
+  connect(model, &QAbstractItemModel::rowsInserted, this, &RichTextDelegate::clearCache);
+  connect(model, &QAbstractItemModel::rowsRemoved, this, &RichTextDelegate::clearCache);
+  connect(model, &QAbstractItemModel::rowsMoved, this, &RichTextDelegate::clearCache);
+  connect(model, &QAbstractItemModel::dataChanged, this, &RichTextDelegate::clearCache);
+}
+
+QSize RichTextDelegate::sizeHint(const QStyleOptionViewItem &option,
+                                 const QModelIndex & /*index*/) const {
+  // one line of text, no need to look at the content
+  return QSize(option.rect.width(), QFontMetrics(option.font).height() + 2 * VERTICAL_PADDING);
+}
+
+const QTextLayout &RichTextDelegate::getLayout(const QStyleOptionViewItem &option,
+                                               const QModelIndex &index) const {
+  const int availableWidth = option.rect.width() - 2 * HORIZONTAL_PADDING;
+  const int width          = std::max(0, availableWidth - availableWidth % WIDTH_BUCKET);
+  const CacheKey key{index.row(), width, static_cast<int>(option.font.pointSizeF() * 100)};
+  const auto cached = layoutCache.find(key);
+  if (cached != layoutCache.end()) {
+    return *cached->second;
+  }
+  if (layoutCache.size() >= MAX_CACHED_LAYOUTS || key.width != cachedWidth ||
+      key.fontSize != cachedFontSize) {
+    layoutCache.clear();
+    cachedWidth    = key.width;
+    cachedFontSize = key.fontSize;
+  }
+
+  // the folder gets shortened in the middle, the name is always shown completely
+  const QString folder = index.data(SearchResultModel::FolderRole).toString();
+  const QString name   = index.data(SearchResultModel::NameRole).toString();
+  const QFontMetrics metrics(option.font);
+  const QString elidedFolder =
+    metrics.elidedText(folder, Qt::ElideMiddle, width - metrics.width(name));
+
+  // exact, case mismatch, confused character, total mismatch
+  QVector<QTextLayout::FormatRange> formats;
+  const MatchRanges ranges =
+    index.data(SearchResultModel::MatchRangesRole).value<MatchRanges>();
+  for (const MatchRange &range : ranges) {
+    QTextCharFormat format;
+    switch (range.score) {
+      case 3:
+        format.setForeground(Qt::darkGreen);
+        format.setFontWeight(QFont::Bold);
+        break;
+      case 2:
+        format.setForeground(Qt::darkGreen);
+        format.setFontItalic(true);
+        break;
+      case 1:
+        format.setForeground(Qt::blue);
+        break;
+      default:
+        continue;
+    }
+    formats.push_back({elidedFolder.size() + range.start, range.length, format});
+  }
+
+  auto layout = std::make_unique<QTextLayout>(elidedFolder + name, option.font);
+  layout->setCacheEnabled(true);
+  layout->setFormats(formats);
+  layout->beginLayout();
+  QTextLine line = layout->createLine();
+  if (line.isValid()) {
+    line.setNumColumns(elidedFolder.size() + name.size());
+    line.setPosition(QPointF(0, 0));
+  }
+  layout->endLayout();
+
+  return *layoutCache.emplace(key, std::move(layout)).first->second;
+}
+
+void RichTextDelegate::paint(QPainter *painter,
+                             const QStyleOptionViewItem &option,
+                             const QModelIndex &index) const {
+  painter->save();
+
+  // Set hover background color
+  if (option.state.testFlag(QStyle::State_MouseOver)) {
+    painter->fillRect(option.rect, QColor(211, 211, 211));  // Light gray for hover
+  }
+
+  painter->setClipRect(option.rect);
+  painter->setPen(option.palette.color(QPalette::Text));
+  const QTextLayout &layout = getLayout(option, index);
+  const qreal top =
+    option.rect.top() + (option.rect.height() - layout.boundingRect().height()) / 2;
+  layout.draw(painter, QPointF(option.rect.left() + HORIZONTAL_PADDING, top));
+
+  painter->restore();
+}
 
 HoverableListWidget::HoverableListWidget(QWidget *parent)
-    : QListWidget(parent) {
+    : QListView(parent) {
   setMouseTracking(true);
+  // all rows have the height of the first one, the view never measures the others
+  setUniformItemSizes(true);
+  setSelectionMode(QAbstractItemView::SingleSelection);
+  setEditTriggers(QAbstractItemView::NoEditTriggers);
 
   clickTimer.setSingleShot(true);
 
@@ -25,15 +122,15 @@ HoverableListWidget::HoverableListWidget(QWidget *parent)
 
   // Handle single-click logic when the timer times out
   connect(&clickTimer, &QTimer::timeout, this, [this]() {
-    // save the pointer for edgecase that secons dingle click and time out occure parallel
-    QListWidgetItem *item = pendingItem;
-    pendingItem = nullptr;
+    // save the index for edgecase that secons dingle click and time out occure parallel
+    const QModelIndex index = pendingIndex;
+    pendingIndex = QPersistentModelIndex();
     clickTimer.stop();
-    if (item == nullptr) {
+    if (!index.isValid()) {
       return;
     }
 
-    QString filePath = item->toolTip();  // Retrieve the full path from the tooltip
+    QString filePath = getFilePath(index);
     QFileInfo fileInfo(filePath);
 
     if (!fileInfo.exists()) {
@@ -51,140 +148,50 @@ HoverableListWidget::HoverableListWidget(QWidget *parent)
   });
 
   // Single-click detection (also triggers twice on double click, so use timer to distinguish)
-  connect(this, &QListWidget::itemClicked, [this](QListWidgetItem *item) {
-    if (pendingItem != nullptr) {
-      pendingItem = nullptr;
+  connect(this, &QListView::clicked, [this](const QModelIndex &index) {
+    if (pendingIndex.isValid()) {
+      pendingIndex = QPersistentModelIndex();
       // Double-click action logic
-      QDesktopServices::openUrl(QUrl::fromLocalFile(item->toolTip()));
+      openFile(index);
       return;
     }
-    pendingItem = item;  // Store item for use in single-click action
+    pendingIndex = index;  // Store index for use in single-click action
     clickTimer.start(getDoubleClickInterval());
   });
 
 #ifdef Q_OS_WIN
   // windows does not propergate the itemCLicked twice on a double click, linux does...
-  connect(this, &QListWidget::itemDoubleClicked, [this](QListWidgetItem *item) {
-    pendingItem = nullptr;
-    QDesktopServices::openUrl(QUrl::fromLocalFile(item->toolTip()));
+  connect(this, &QListView::doubleClicked, [this](const QModelIndex &index) {
+    pendingIndex = QPersistentModelIndex();
+    openFile(index);
   });
 #endif
 }
 
-void HoverableListWidget::mouseMoveEvent(QMouseEvent *event) {
-  QListWidget::mouseMoveEvent(event);
-}
-
-void HoverableListWidget::leaveEvent(QEvent *event) {
-  QListWidget::leaveEvent(event);
-}
-
-void HoverableListWidget::resizeEvent(QResizeEvent *event) {
-  QListWidget::resizeEvent(event);
-
-  setUpdatesEnabled(false);
-  // Recalculate ellipses for all items based on the new size
-  for (int i = 0; i < QListWidget::count(); ++i) {
-    QListWidgetItem *item = QListWidget::item(i);
-    const QString fullPath = shortenPathWithEllipsis(i) + entries[i].rightPathPartWithHtml;
-    item->setText(fullPath);
-  }
-
-  setUpdatesEnabled(true);
-  viewport()->update();
-}
-
-void HoverableListWidget::scrollContentsBy(int dx, int dy) {
-  QListWidget::scrollContentsBy(dx, dy);
-
-  if (dy < 0) {
-    for (size_t i = lastVisibleIndex + 1; i < entries.size() && dy < 0; ++i, ++dy) {
-      makeEntrieVisible(i);
-      lastVisibleIndex = i;
-    }
-  }
-}
-
-int HoverableListWidget::getWordWidth(const QString &word) const {
-  QFontMetrics fm = QPainter(viewport()).fontMetrics();
-  return fm.width(word);
-}
-
-QString HoverableListWidget::shortenPathWithEllipsis(const size_t entryIndex) const {
-  QFontMetrics metrics(font());
-  constexpr int MAGIC_PADDING = 25;
-  const int availableWidth = viewport()->width() - MAGIC_PADDING -
-                             metrics.width(entries[entryIndex].rightPathPart);
-
-  return metrics.elidedText(entries[entryIndex].leftPathPart, Qt::ElideMiddle, availableWidth);
-}
-
-size_t HoverableListWidget::getNumItemsBeforeScrollbar() const {
-  if (QListWidget::count() > 0) {
-    const int viewportHeight = viewport()->height();
-    const int itemHeight =
-        QListWidget::visualRect(QListWidget::model()->index(0, 0)).height();
-
-    if (viewportHeight > 0 && itemHeight > 0) {
-      return static_cast<size_t>(viewportHeight / itemHeight);
-    }
-  }
-  return 42;
+QString HoverableListWidget::getFilePath(const QModelIndex &index) const {
+  return index.data(SearchResultModel::PathRole).toString();
 }
 
-void HoverableListWidget::addSearchResultItem(const std::filesystem::path &searchResult) {
-
-  QString path =
-      QString::fromStdWString(searchResult.parent_path().wstring()) + "/";
-  const std::wstring match = util::getLastPathComponent(searchResult);
-  QString rightPathPart = QString::fromStdWString(match);
-  // +5 just in case: we want to see a scrollbar to trigger the scroll event
-  const bool visible = QListWidget::count() < getNumItemsBeforeScrollbar() + 5;
-  entries.emplace_back(ItemInfo{path, rightPathPart, rightPathPart, visible});
-
-  if (visible) {
-    lastVisibleIndex = entries.size() - 1;
-    makeEntrieVisible(lastVisibleIndex);
+void HoverableListWidget::openFile(const QModelIndex &index) {
+  const QString filePath = getFilePath(index);
+  QDesktopServices::openUrl(QUrl::fromLocalFile(filePath));
+  if (openedCallback) {
+    openedCallback(filePath.toStdWString());
   }
 }
 
-void HoverableListWidget::makeEntrieVisible(const size_t entriyIndex) {
-  static std::unordered_map<int, QString> scoreEmphasis = {
-      {3, "color: green; font-weight: bold;"},    // Exact match
-      {2, "color: green; font-weight: italic;"},  // Case mismatch
-      {1, "color: blue;"},                        // Confused character
-      {0, "color: black;"},                       // Total mismatch
-  };
-  assert(entries.size() > entriyIndex);
-
-  const std::wstring match = entries[entriyIndex].rightPathPart.toStdWString();
-  std::vector<int> scores = Dictionary::getMatchScores(searchInput, match);
-
-  QString emphasizedMatch;
-  for (size_t i = 0; i < match.size(); ++i) {
-    QString style = scoreEmphasis[scores[i]];
-    emphasizedMatch +=
-        QString("<span style='%1'>%2</span>").arg(style).arg(QString(match[i]));
+void HoverableListWidget::resizeEvent(QResizeEvent *event) {
+  // Dragging a splitter resizes many times per frame. Stop painting until the events
+  // of this frame are handled and repaint once with the final width.
+  if (!repaintScheduled) {
+    repaintScheduled = true;
+    viewport()->setUpdatesEnabled(false);
+    QTimer::singleShot(0, this, [this]() {
+      repaintScheduled = false;
+      viewport()->setUpdatesEnabled(true);  // this schedules the repaint
+    });
   }
-  entries[entriyIndex].rightPathPartWithHtml = emphasizedMatch;
-
-
-  QString fullPathStr = shortenPathWithEllipsis(entriyIndex) + emphasizedMatch;
-
-
-  QListWidgetItem *item = new QListWidgetItem(fullPathStr);
-  item->setToolTip(QString::fromStdWString(entries[entriyIndex].getPath().wstring()));
-  item->setFlags(item->flags() | Qt::ItemIsSelectable);
-  QFont font = QWidget::font();
-  item->setFont(font);  // set font to listen to scale change
-  QListWidget::addItem(item);
-}
-
-void HoverableListWidget::clear(const size_t newSize) {
-  entries.clear();
-  entries.reserve(newSize);
-  lastVisibleIndex = 0;
-  QListWidget::clear();
+  QListView::resizeEvent(event);
 }
 
 void HoverableListWidget::changeScale(const double scale_factor) {
@@ -192,11 +199,8 @@ void HoverableListWidget::changeScale(const double scale_factor) {
   font.setPointSizeF(font.pointSizeF() * scale_factor);
   setFont(font);  // Apply to all items
 
-  // Notify the delegate/view to update item sizes
-  updateGeometries();
-  for (int i = 0; i < count(); ++i) {
-    item(i)->setSizeHint(sizeHintForIndex(model()->index(i, 0)));
-  }
+  // The row height depends on the font, let the view measure it again.
+  scheduleDelayedItemsLayout();
 
   // Optionally, force a repaint to make sure changes appear immediately
   viewport()->update();
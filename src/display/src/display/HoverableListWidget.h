@@ -1,116 +1,122 @@
 #pragma once
 
-#include <QListWidget>
+#include <display/SearchResultModel.h>
+
+#include <QAbstractItemModel>
+#include <QFontMetrics>
+#include <QListView>
 #include <QObject>
 #include <QPainter>
+#include <QPersistentModelIndex>
 #include <QStyledItemDelegate>
-#include <QTextDocument>
+#include <QTextLayout>
 #include <QTimer>
 #include <filesystem>
 #include <functional>
 #include <globals/globals.hpp>
-#include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 
+/*!
+ * \brief Paints a result row: the folder, shortened in the middle, followed by the name
+ * colored by how well its characters match the search.
+ *
+ * The text is laid out once with QTextLayout and the layout is cached per row, width and
+ * font size, so scrolling and hovering only draw already shaped glyphs. The width is
+ * rounded down to WIDTH_BUCKET pixels, so resizing re-elides a row only every few pixels.
+ * All rows have the height of one line of text.
+ */
 class RichTextDelegate : public QStyledItemDelegate {
+  Q_OBJECT
+
  public:
   using QStyledItemDelegate::QStyledItemDelegate;
 
-  // Calculate item height based on HTML content
-  QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override {
-    QTextDocument doc;
-    doc.setDefaultFont(option.font);  // Use scaled font size
-    doc.setHtml(index.data().toString());
-    doc.setTextWidth(option.rect.width());  // Match document width to item width
-    return QSize(option.rect.width(), doc.size().height());
-  }
+  /*!
+   * \brief Drop cached layouts whenever the rows of the model change.
+   */
+  void watchModel(const QAbstractItemModel *model);
 
-  // Render HTML content with hover and selection effects
-  void paint(QPainter *painter,
-             const QStyleOptionViewItem &option,
-             const QModelIndex &index) const override {
-    if (index.data().canConvert<QString>()) {
-      QString text = index.data().toString();
-      QTextDocument doc;
-      doc.setHtml(text);
+  void clearCache() { layoutCache.clear(); }
 
-      // use the font from parent
-      QFont scaledFont = option.font;
-      doc.setDefaultFont(scaledFont);
+  QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
 
-      // Set document width to the available item width
-      doc.setTextWidth(option.rect.width());
+  void paint(QPainter *painter,
+             const QStyleOptionViewItem &option,
+             const QModelIndex &index) const override;
 
-      painter->save();
+ private:
+  struct CacheKey {
+    int row;
+    // the width available for the text, rounded down to a multiple of WIDTH_BUCKET
+    int width;
+    // point size of the font times 100, changes with the scale of the widget
+    int fontSize;
+    bool operator==(const CacheKey &other) const {
+      return row == other.row && width == other.width && fontSize == other.fontSize;
+    }
+  };
+  struct CacheKeyHash {
+    size_t operator()(const CacheKey &key) const {
+      return std::hash<int>()(key.row) ^ (std::hash<int>()(key.width) << 1) ^
+             (std::hash<int>()(key.fontSize) << 2);
+    }
+  };
 
-      // Set hover background color
-      if (option.state.testFlag(QStyle::State_MouseOver)) {
-        painter->fillRect(option.rect, QColor(211, 211, 211));  // Light gray for hover
-      }
+  const QTextLayout &getLayout(const QStyleOptionViewItem &option,
+                               const QModelIndex &index) const;
 
-      painter->setClipRect(option.rect);
-      painter->translate(option.rect.topLeft());  // Align at top-left
-      doc.drawContents(painter);                  // Render full content
+  static constexpr int HORIZONTAL_PADDING = 4;
+  static constexpr int VERTICAL_PADDING   = 2;
+  static constexpr int WIDTH_BUCKET       = 16;
+  // a few screens full of rows, the cache is dropped completely when it grows larger
+  static constexpr size_t MAX_CACHED_LAYOUTS = 1024;
 
-      painter->restore();
-    } else {
-      QStyledItemDelegate::paint(painter, option, index);
-    }
-  }
+  mutable std::unordered_map<CacheKey, std::unique_ptr<QTextLayout>, CacheKeyHash> layoutCache;
+  // width and font size of the cached layouts, layouts of other sizes are never used again
+  mutable int cachedWidth    = 0;
+  mutable int cachedFontSize = 0;
 };
 
-class HoverableListWidget : public QListWidget {
+/*!
+ * \brief Shows the rows of a SearchResultModel. All rows have the same height,
+ * so the view only ever touches the rows on screen, no matter how many results there are.
+ */
+class HoverableListWidget : public QListView {
   Q_OBJECT
 
  public:
   using GetDoubleClickInterval = std::function<int()>;
+  using OpenedCallback         = std::function<void(const std::filesystem::path &)>;
 
   HoverableListWidget(QWidget *parent = nullptr);
-  void addSearchResultItem(const std::filesystem::path &searchResult);
-
-  void setSearchInput(const std::wstring &needle) { searchInput = needle; }
-
-
-  void clear(const size_t newSize);
 
   void setDoubleClickIntervalFunction(const GetDoubleClickInterval &func) {
     getDoubleClickInterval = func;
   }
 
+  /*!
+   * \brief Called with the path of every result the user opened with a double click.
+   */
+  void setOpenedCallback(const OpenedCallback &callback) { openedCallback = callback; }
+
   void changeScale(const double scale_factor);
 
- private:
-  GetDoubleClickInterval getDoubleClickInterval = []() { return 255; };
-  void mouseMoveEvent(QMouseEvent *event) override;
-  void leaveEvent(QEvent *event) override;
+ protected:
   void resizeEvent(QResizeEvent *event) override;
-  void scrollContentsBy(int dx, int dy) override;
-
-  QString shortenPathWithEllipsis(const size_t entriyIndex) const;
-
-  void makeEntrieVisible(const size_t entriyIndex);
 
-  int getWordWidth(const QString &word) const;
+ private:
+  GetDoubleClickInterval getDoubleClickInterval = []() { return 255; };
+  OpenedCallback openedCallback;
 
-  size_t getNumItemsBeforeScrollbar() const;
+  QString getFilePath(const QModelIndex &index) const;
+  void openFile(const QModelIndex &index);
 
   QTimer clickTimer;
-  QListWidgetItem *pendingItem = nullptr;
-
-  struct ItemInfo {
-    QString leftPathPart;
-    QString rightPathPart;
-    QString rightPathPartWithHtml;
-    bool visible;
-
-    std::filesystem::path getPath() const {
-      std::filesystem::path path(leftPathPart.toStdWString());
-      return path / rightPathPart.toStdWString();
-    }
-  };
-
-  std::vector<ItemInfo> entries;
-  std::wstring searchInput;
-  size_t lastVisibleIndex;
+  // a resize only schedules a repaint, all resizes of one frame share it
+  bool repaintScheduled = false;
+  // persistent: it becomes invalid instead of dangling if the results change meanwhile
+  QPersistentModelIndex pendingIndex;
 };
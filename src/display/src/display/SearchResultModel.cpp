@@ -0,0 +1,154 @@
+#include <display/SearchResultModel.h>
+
+#include <algorithm>
+
+
+SearchResultModel::SearchResultModel(QObject *parent)
+    : QAbstractListModel(parent) {}
+
+int SearchResultModel::rowCount(const QModelIndex &parent) const {
+  if (parent.isValid()) {
+    return 0;  // a list has no children
+  }
+  return static_cast<int>(ids.size());
+}
+
+QVariant SearchResultModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() < 0 || index.row() >= rowCount() || !shown) {
+    return QVariant();
+  }
+  const EntryId id             = ids[index.row()];
+  const Dictionary &dictionary = *shown->dictionary;
+
+  switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+      return QString::fromStdWString(dictionary.getName(id));
+    case MatchRangesRole:
+      return QVariant::fromValue(getMatchRanges(id, dictionary.getName(id)));
+    case FolderRole:
+      return QString::fromStdWString(dictionary.getPath(id).parent_path().wstring()) + "/";
+    case Qt::ToolTipRole:
+    case PathRole:
+      return QString::fromStdWString(dictionary.getPath(id).wstring());
+    default:
+      return QVariant();
+  }
+}
+
+MatchRanges SearchResultModel::getMatchRanges(const EntryId id, const std::wstring &name) const {
+  const auto cached = matchRangesCache.find(id);
+  if (cached != matchRangesCache.end()) {
+    return cached->second;
+  }
+  if (matchRangesCache.size() >= MAX_CACHED_MATCH_RANGES) {
+    matchRangesCache.clear();
+  }
+
+  if (scoreBuffer.size() < name.size()) {
+    scoreBuffer.resize(name.size());
+  }
+  Dictionary::getMatchScores(shown->needle, name, scoreBuffer.data());
+
+  // QString counts utf16 units, a wchar_t outside the BMP needs two of them
+  MatchRanges ranges;
+  int position = 0;
+  for (size_t i = 0; i < name.size(); ++i) {
+    const int length = static_cast<uint32_t>(name[i]) > 0xFFFF ? 2 : 1;
+    if (!ranges.isEmpty() && ranges.back().score == scoreBuffer[i]) {
+      ranges.back().length += length;
+    } else {
+      ranges.push_back({position, length, scoreBuffer[i]});
+    }
+    position += length;
+  }
+  matchRangesCache.emplace(id, ranges);
+  return ranges;
+}
+
+void SearchResultModel::applyUpdate(const std::shared_ptr<const SearchResult> &results) {
+  const ResultUpdate &update = results->update;
+  if (!shown || !update.appliesTo(shown->update.version) ||
+      results->dictionary != shown->dictionary) {
+    resetTo(results);
+    return;
+  }
+  for (const ResultChange &change : update.changes) {
+    if (!applyChange(change)) {
+      resetTo(results);
+      return;
+    }
+  }
+
+  const bool searchChanged = results->needle != shown->needle;
+  shown                    = results;
+  if (searchChanged) {
+    matchRangesCache.clear();
+  }
+  if (searchChanged && !ids.empty()) {
+    // the same rows match the new search differently
+    emit dataChanged(index(0), index(rowCount() - 1), {MatchRangesRole});
+  }
+}
+
+bool SearchResultModel::applyChange(const ResultChange &change) {
+  if (!fitsResults(change, ids.size())) {
+    return false;
+  }
+  // the rows change the same way as everywhere else, only the views are told about it
+  const int position = static_cast<int>(change.position);
+  switch (change.type) {
+    case ResultChange::Type::INSERT:
+      if (change.ids.empty()) {
+        break;  // Qt has no empty ranges of rows
+      }
+      beginInsertRows(QModelIndex(), position, position + change.ids.size() - 1);
+      applyResultChange(change, ids);
+      endInsertRows();
+      break;
+    case ResultChange::Type::REMOVE:
+      if (change.count == 0) {
+        break;
+      }
+      beginRemoveRows(QModelIndex(), position, position + change.count - 1);
+      applyResultChange(change, ids);
+      endRemoveRows();
+      break;
+    case ResultChange::Type::MOVE: {
+      if (change.position == change.target) {
+        break;
+      }
+      // Qt wants the row in front of which the moved row goes, counted before the move
+      const int target      = static_cast<int>(change.target);
+      const int destination = change.target < change.position ? target : target + 1;
+      beginMoveRows(QModelIndex(), position, position, QModelIndex(), destination);
+      applyResultChange(change, ids);
+      endMoveRows();
+      break;
+    }
+  }
+  return true;
+}
+
+void SearchResultModel::resetTo(const std::shared_ptr<const SearchResult> &results) {
+  beginResetModel();
+  ids   = results->dictionary ? results->update.ranking : std::vector<EntryId>();
+  shown = results;
+  matchRangesCache.clear();
+  endResetModel();
+}
+
+void SearchResultModel::clear() {
+  beginResetModel();
+  ids.clear();
+  shown.reset();
+  matchRangesCache.clear();
+  endResetModel();
+}
+
+std::filesystem::path SearchResultModel::getPath(const int row) const {
+  if (row < 0 || row >= rowCount() || !shown) {
+    return std::filesystem::path();
+  }
+  return shown->dictionary->getPath(ids[row]);
+}
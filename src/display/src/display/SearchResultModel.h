@@ -0,0 +1,78 @@
+#pragma once
+
+#include <finder/SearchResult.h>
+
+#include <QAbstractListModel>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * \brief Consecutive characters of a result name which matched the search equally well.
+ * score as returned by Dictionary::scoreChars: 3 exact, 2 case mismatch, 1 confused, 0 none
+ */
+struct MatchRange {
+  int start;
+  int length;
+  int score;
+};
+using MatchRanges = QVector<MatchRange>;
+Q_DECLARE_METATYPE(MatchRanges)
+
+/*!
+ * \brief Holds the ids of the current search results.
+ *
+ * Nothing is converted up front: the view only asks for the rows it shows,
+ * and only then the path of a row is decoded from the dictionary.
+ */
+class SearchResultModel : public QAbstractListModel {
+  Q_OBJECT
+
+ public:
+  enum Roles {
+    // QString: the folder containing the result, with a trailing separator
+    FolderRole = Qt::UserRole + 1,
+    // QString: the name of the result
+    NameRole,
+    // MatchRanges: how well the characters of the name match the search
+    MatchRangesRole,
+    // QString: the complete path
+    PathRole,
+  };
+
+  explicit SearchResultModel(QObject *parent = nullptr);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+  /*!
+   * \brief Apply the changes of an update row by row, so the view keeps its scroll
+   * position and hovered row. Falls back to a reset if the update does not continue
+   * the shown ranking.
+   */
+  void applyUpdate(const std::shared_ptr<const SearchResult> &results);
+  void clear();
+
+  std::filesystem::path getPath(const int row) const;
+
+ private:
+  MatchRanges getMatchRanges(const EntryId id, const std::wstring &name) const;
+  bool applyChange(const ResultChange &change);
+  void resetTo(const std::shared_ptr<const SearchResult> &results);
+
+  // the rows, they equal the ranking of shown once an update is applied
+  std::vector<EntryId> ids;
+  // the last applied results: their dictionary, search and version
+  std::shared_ptr<const SearchResult> shown;
+
+  // highlighting of the rows asked for so far, valid for the needle of shown
+  mutable std::unordered_map<EntryId, MatchRanges> matchRangesCache;
+  mutable std::vector<int> scoreBuffer;
+  // about a few screens of rows, dropped completely when it grows larger
+  static constexpr size_t MAX_CACHED_MATCH_RANGES = 4096;
+};
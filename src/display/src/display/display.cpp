@@ -1,5 +1,6 @@
 #include "display.h"
 
+#include <algorithm>
 #include <functional>
 #include <globals/globals.hpp>
 #include <globals/macros.hpp>
@@ -10,6 +11,7 @@ Display::Display()
   put<std::string>(&split_widget_state, SPLIT_WIDGET_STATE, true);
   put<int>(&disp_scale, DISP_SCALE, true);
   put<int>(&doubleClickInterval_ms, DOUBLE_CLICK_INTERVAL, true);
+  put<std::string>(&last_root_folder, LAST_ROOT_FOLDER, true);
 }
 
 Display::~Display() {
@@ -28,24 +30,41 @@ Display::~Display() {
 void Display::visualize() const { finder.visualize(); }
 
 void Display::save() {
-  // todo
-  // go into cache folder
-  // create all folders like the root path
-  // in the last folder save the current index
-  if (!finder.saveCurrentIndex(finder.getRootFolder() /
-                               Globals::getInstance().getBinaryFileIndex())) {
-    std::wstring msg(
-      L"Failed to save index to " +
-      (finder.getRootFolder() / Globals::getInstance().getBinaryFileIndex()).wstring());
-    popup_error(msg, L"Error Saveing");
+  // Never write into the indexed folder itself, it might be read only.
+  // The index is written in the background, only failures are reported.
+  const auto cacheFile = Finder::getIndexCacheFile(finder.getRootFolder());
+  const bool started =
+    finder.saveCurrentIndex(cacheFile, [this](bool success, const std::wstring& msg) {
+      if (success) {
+        setStatus(msg);
+      } else {
+        popup_error(msg, L"Error Saveing");
+      }
+    });
+  if (!started) {
+    popup_error(L"There is no index to save yet.", L"Error Saveing");
   }
 }
 
 
 void Display::loadOldIndex() {
-  // todo
-  // go into cache folder
-  // see if the root path was aved and an index file is found
+  if (last_root_folder.empty()) {
+    return;
+  }
+  // stored as utf8 to survive non ascii paths on every platform
+  const std::filesystem::path root(
+    std::u8string(last_root_folder.begin(), last_root_folder.end()));
+  if (!std::filesystem::is_directory(root)) {
+    return;
+  }
+
+  setStatus(L"Loading index of " + root.wstring());
+  finder.loadCachedIndex(root,
+                         std::bind(&Display::callbackIndexing,
+                                   this,
+                                   std::placeholders::_1,
+                                   std::placeholders::_2,
+                                   std::placeholders::_3));
 }
 
 void Display::open() {
@@ -59,35 +78,39 @@ void Display::open() {
     return;
   }
 
-  if (finder.isWorking()) {
-    finder.stopCurrentWorker();
-  }
+  const std::u8string utf8Root = choosenPath.u8string();
+  last_root_folder             = std::string(utf8Root.begin(), utf8Root.end());
 
   setStatus(L"Searching through root Folder: " + choosenPath.wstring());
   resetDisplayElements();
-  finder.setRootPath(
-    choosenPath,
-    std::bind(&Display::callbackIndexing, this, std::placeholders::_1, std::placeholders::_2));
+  // setting a new root cancels running indexing and searching without blocking
+  finder.setRootPath(choosenPath,
+                     std::bind(&Display::callbackIndexing,
+                               this,
+                               std::placeholders::_1,
+                               std::placeholders::_2,
+                               std::placeholders::_3));
 }
 
 
 bool Display::exitGracefully() {
-  if (finder.isWorking()) {
-    finder.stopCurrentWorker();
-  }
-  // todo dont block. make a callback and check after 1 second: if still working... kill
+  // Only request the workers to stop, they are joined when the finder is destroyed.
+  finder.stopIndexing();
+  finder.stopSearching();
   return true;
 }
 
-void Display::callbackIndexing(bool success, const std::wstring& msg) {
+void Display::callbackIndexing(bool success, bool finnished, const std::wstring& msg) {
   if (success) {
-    if (!finder.isInitiated()) {
+    if (!finnished) {
       setStatus(L"Indexing: " + msg);
     } else {
       setStatus(L"Indexing finnished: " + msg);
+      // still on the indexing thread, walking the tree does not block the GUI
       updateInfo(finder.getRootFolder().wstring(),
                  finder.getNumEntries(),
-                 finder.getIndexingDate());
+                 finder.getIndexingDate(),
+                 finder.getIndexStatistics());
     }
   } else {
     popup_error(L"Indexing stopped: " + msg, L"Error");
@@ -99,26 +122,74 @@ void Display::search(const std::wstring& needel) {
     return;
   }
   last_search = needel;
+  int delay_ms;
+  {
+    std::lock_guard<std::mutex> lock(search_mutex);
+    // only the newest input is searched, older ones which did not start yet are dropped
+    pending_search = needel;
+    search_pending = true;
+    delay_ms       = getSearchDelay();
+  }
+  scheduleSearch(delay_ms);
+}
+
+int Display::getSearchDelay() const {
+  // Waiting about as long as a search takes costs nothing noticeable: a search
+  // started earlier would be cancelled by the next keystroke anyway.
+  return std::min(static_cast<int>(search_latency_ms), MAX_SEARCH_DELAY_MS);
+}
+
+void Display::runScheduledSearch() {
+  std::wstring needel;
+  {
+    std::lock_guard<std::mutex> lock(search_mutex);
+    if (!search_pending) {
+      return;
+    }
+    needel         = pending_search;
+    search_pending = false;
+    search_running = true;
+    running_search = needel;
+    search_start   = std::chrono::steady_clock::now();
+  }
   setStatus(L"Search for " + needel);
+  // cancels a still running search, its results are outdated
   finder.search(needel,
-                std::bind(&Display::callbackSearch,
-                          this,
-                          std::placeholders::_1,
-                          std::placeholders::_2,
-                          std::placeholders::_3));
+                std::bind(&Display::callbackSearch, this, std::placeholders::_1));
 }
 
 void Display::searchAgain() { search(last_search); }
 
-void Display::callbackSearch(bool finnished,
-                             const std::vector<std::filesystem::path>& results,
-                             const std::wstring& search) {
-  setSearchResults(results, search);
-  if (finnished) {
-    setStatus(L"Search finnished, found " + std::to_wstring(results.size()) +
-              L" matches");
+void Display::callbackSearch(const std::shared_ptr<const SearchResult>& results) {
+  if (results->finished) {
+    std::lock_guard<std::mutex> lock(search_mutex);
+    if (search_running && results->needle == running_search) {
+      const double duration_ms = std::chrono::duration<double, std::milli>(
+                                   std::chrono::steady_clock::now() - search_start)
+                                   .count();
+      search_running    = false;
+      search_latency_ms = search_latency_ms == 0.
+                            ? duration_ms
+                            : SEARCH_LATENCY_WEIGHT * duration_ms +
+                                (1. - SEARCH_LATENCY_WEIGHT) * search_latency_ms;
+    }
+  }
+  setSearchResults(results);
+  const size_t numResults = results->update.ranking.size();
+  if (results->finished && results->incomplete) {
+    setStatus(L"Search time limit reached, best " + std::to_wstring(numResults) +
+              L" matches so far");
+  } else if (results->finished) {
+    // the most common extensions, narrow the search with "ext:..."
+    std::wstring facets;
+    for (const ExtensionCount& facet : results->extensionCounts) {
+      facets += std::wstring(facets.empty() ? L" (" : L", ") + L"." + facet.extension + L": " +
+                std::to_wstring(facet.count);
+    }
+    setStatus(L"Search finnished, found " + std::to_wstring(numResults) + L" matches" +
+              (facets.empty() ? L"" : facets + L")"));
   } else {
-    setStatus(L"searching ... " + std::to_wstring(results.size()));
+    setStatus(L"searching ... " + std::to_wstring(numResults));
   }
 }
 
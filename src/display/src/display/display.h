@@ -4,8 +4,10 @@
 #include <finder/Finder.h>
 
 #include <array>
+#include <chrono>
 #include <filesystem>
 #include <functional>
+#include <mutex>
 #include <settings/settings.hpp>
 #include <string>
 
@@ -23,6 +25,10 @@ class Display : public DisplaySettings {
   using setSearchResult = std::function<void(const std::vector<std::string>&)>;
 
   // <SEARCH> functionallity is public for Bad Boy reinterpret_cast<come and arrestme> magic
+  /*!
+   * \brief Schedule a search. Bursts of calls (typing) are coalesced, only the newest
+   * search is started once the input settled for about as long as searches take.
+   */
   void search(const std::wstring&);
   void searchAgain();
 
@@ -44,6 +50,10 @@ class Display : public DisplaySettings {
   }
   float getFuzzyCoeff() const { return finder.getFuzzyCoefficient(); }
   void setFuzzyCoeff(const float coef) { finder.setFuzzyCoefficient(coef); }
+  bool ranksByOpenHistory() const { return finder.isSetRankByOpenHistory(); }
+  void setRankByOpenHistory(const bool rank) { finder.setRankByOpenHistory(rank); }
+  // results the user opened rank higher in later searches
+  void recordOpened(const std::filesystem::path& path) { finder.recordOpened(path); }
   // </SEARCH>
   int getDoubleClickInterval() const { return doubleClickInterval_ms; }
 
@@ -57,6 +67,11 @@ class Display : public DisplaySettings {
   void open();
   void save();
   void visualize() const;
+
+  /*!
+   * \brief Load the cached index of the last used root folder in the background
+   * and check it for changes afterwards.
+   */
   void loadOldIndex();
 
   /*!
@@ -116,11 +131,22 @@ class Display : public DisplaySettings {
 
   /*!
    * \brief Display the search results
-   * \param results The results of a search
-   * \param search The original search string
+   * \param results The ids of the results of a search, best first, and the changes
+   * against the previous call. Calls must not be skipped, or the changes do not apply.
+   * The snapshot is shared with the finder, keep the pointer instead of copying it.
+   */
+  virtual void setSearchResults(const std::shared_ptr<const SearchResult>& results) = 0;
+
+  /*!
+   * \brief Call runScheduledSearch() after delay_ms on the ui thread.
+   * A call scheduled before and not yet run is replaced.
    */
-  virtual void setSearchResults(const std::vector<std::filesystem::path>& searchResults,
-                                const std::wstring& search) = 0;
+  virtual void scheduleSearch(const int delay_ms) = 0;
+
+  /*!
+   * \brief Start the newest scheduled search, if it was not started yet.
+   */
+  void runScheduledSearch();
 
   /*!
    * \brief Reset Display to "uninitiated"
@@ -132,13 +158,21 @@ class Display : public DisplaySettings {
    * \param root_path A string displaying the root of the search
    * \param num_files The number of files in the index
    * \param indexing_date The date of the indexing
+   * \param statistics Size and memory of the index
    */
   virtual void updateInfo(const std::wstring& root_path,
                           const size_t num_files,
-                          const std::wstring& indexingDate) = 0;
+                          const std::wstring& indexingDate,
+                          const IndexStatistics& statistics) = 0;
 
   [[nodiscard]] bool exitGracefully();
 
+  /*!
+   * \brief Wait until all finder jobs are gone. Call this before the child
+   * class gets destroyed, since the jobs report back through its virtual functions.
+   */
+  void joinFinder() { finder.joinWorkers(); }
+
   const std::array<int, 4>& getDisplayProportions() const {
     return disp_pos_size;
   }
@@ -177,10 +211,8 @@ class Display : public DisplaySettings {
   bool isReadyToSearch() const { return finder.isInitiated(); }
 
  private:
-  void callbackIndexing(bool success, const std::wstring& msg);
-  void callbackSearch(bool finnished,
-                      const std::vector<std::filesystem::path>& results,
-                      const std::wstring& search);
+  void callbackIndexing(bool success, bool finnished, const std::wstring& msg);
+  void callbackSearch(const std::shared_ptr<const SearchResult>& results);
 
 
   // calculation
@@ -188,6 +220,19 @@ class Display : public DisplaySettings {
 
   std::wstring last_search;
 
+  // search scheduling, the finder reports back from its own threads
+  int getSearchDelay() const;
+  std::mutex search_mutex;
+  bool search_pending = false;
+  std::wstring pending_search;
+  bool search_running = false;
+  std::wstring running_search;
+  std::chrono::steady_clock::time_point search_start;
+  // exponentially weighted moving average of the time until a search finished
+  double search_latency_ms = 0.;
+  static constexpr double SEARCH_LATENCY_WEIGHT = 0.3;
+  static constexpr int MAX_SEARCH_DELAY_MS      = 300;
+
 
   // SETTINGS
   std::array<int, 4> disp_pos_size        = {{50, 50, 600, 400}};
@@ -198,4 +243,6 @@ class Display : public DisplaySettings {
   const std::string DISP_SCALE            = "DisplayScale";
   int doubleClickInterval_ms              = 250;
   const std::string DOUBLE_CLICK_INTERVAL = "DoubleClickInterval";
+  std::string last_root_folder            = "";
+  const std::string LAST_ROOT_FOLDER      = "LastRootFolder";
 };
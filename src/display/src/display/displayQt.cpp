@@ -20,6 +20,9 @@ DisplayQt::DisplayQt()
 
   loadSplitterState();
 
+  search_timer.setSingleShot(true);
+  connect(&search_timer, &QTimer::timeout, this, [this]() { runScheduledSearch(); });
+
   setCentralWidget(splitter);
 
   // Create a main layout to stack the top widget and the splitter
@@ -52,8 +55,12 @@ DisplayQt::DisplayQt()
   setWindowIcon(icon);
 
   DisplayQt::setStatus(L"ready!", 0);
+
+  loadOldIndex();
 }
 
+DisplayQt::~DisplayQt() { joinFinder(); }
+
 void DisplayQt::resetDisplayElements() {
   finder_widget->reset();
   finder_output_widget->reset();
@@ -61,8 +68,9 @@ void DisplayQt::resetDisplayElements() {
 
 void DisplayQt::updateInfo(const std::wstring& root_path,
                            const size_t num_files,
-                           const std::wstring& indexingDate) {
-  finder_widget->updateInfo(root_path, num_files, indexingDate);
+                           const std::wstring& indexingDate,
+                           const IndexStatistics& statistics) {
+  finder_widget->updateInfo(root_path, num_files, indexingDate, statistics);
 }
 
 void DisplayQt::onScaleChanged(const QString& scaleText) {
@@ -368,7 +376,10 @@ void DisplayQt::createStatusBar() {
 }
 
 
-void DisplayQt::setSearchResults(const std::vector<std::filesystem::path>& searchResults,
-                                 const std::wstring& search) {
-  finder_output_widget->setSearchResults(searchResults, search);
+void DisplayQt::scheduleSearch(const int delay_ms) {
+  search_timer.start(delay_ms);  // restarts a pending timer
+}
+
+void DisplayQt::setSearchResults(const std::shared_ptr<const SearchResult>& results) {
+  finder_output_widget->setSearchResults(results);
 }
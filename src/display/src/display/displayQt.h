@@ -5,6 +5,7 @@
 #include <QMainWindow>
 #include <QObject>
 #include <QSplitter>
+#include <QTimer>
 
 #include "display.h"
 #include "finderOutputWidget.h"
@@ -16,15 +17,16 @@ class DisplayQt : public QMainWindow, public Display {
  public:
   DisplayQt();
 
-  ~DisplayQt() override = default;
+  ~DisplayQt() override;
 
  protected:
   void closeEvent(QCloseEvent *event) override;
   void resizeEvent(QResizeEvent *event) override;
   void moveEvent(QMoveEvent *event) override;
 
-  void setSearchResults(const std::vector<std::filesystem::path> &searchResults,
-                        const std::wstring &search) override;
+  void setSearchResults(const std::shared_ptr<const SearchResult> &results) override;
+
+  void scheduleSearch(const int delay_ms) override;
 
  private:
   void setStatus(const std::wstring &msg, int timeout = 0) override;
@@ -44,7 +46,8 @@ class DisplayQt : public QMainWindow, public Display {
 
   void updateInfo(const std::wstring &root_path,
                   const size_t num_files,
-                  const std::wstring &indexingDate) override;
+                  const std::wstring &indexingDate,
+                  const IndexStatistics &statistics) override;
 
   std::filesystem::path openDirChooserDialog() override;
 
@@ -87,6 +90,8 @@ class DisplayQt : public QMainWindow, public Display {
   QAction *visualizeAct;
   QAction *saveIndexAct;
 
+  QTimer search_timer;
+
   FinderWidget *finder_widget;
   FinderOutputWidget *finder_output_widget;
   QSplitter *splitter;
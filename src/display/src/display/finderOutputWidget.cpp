@@ -17,6 +17,7 @@
 #include <QThread>
 #include <QUrl>
 #include <QVBoxLayout>
+#include <globals/instrumentation.hpp>
 #include <globals/macros.hpp>
 #include <globals/timer.hpp>
 #include <string>
@@ -48,11 +49,17 @@ QGroupBox *FinderOutputWidget::create_resultField() {
   QGroupBox *resultGroup = new QGroupBox("Search Results");
 
   QVBoxLayout *vbox = new QVBoxLayout(this);
-  resultList = new HoverableListWidget(this);
+  resultList  = new HoverableListWidget(this);
+  resultModel = new SearchResultModel(resultList);
+  resultList->setModel(resultModel);
   resultList->setToolTipDuration(10000);
-  resultList->setItemDelegate(new RichTextDelegate(resultList));
+  RichTextDelegate *delegate = new RichTextDelegate(resultList);
+  delegate->watchModel(resultModel);
+  resultList->setItemDelegate(delegate);
   resultList->setDoubleClickIntervalFunction(
       std::bind(&Display::getDoubleClickInterval, displayQt));
+  resultList->setOpenedCallback(
+      std::bind(&Display::recordOpened, displayQt, std::placeholders::_1));
 
   vbox->addWidget(resultList);
   resultGroup->setLayout(vbox);
@@ -60,34 +67,19 @@ QGroupBox *FinderOutputWidget::create_resultField() {
 }
 
 
-void FinderOutputWidget::setSearchResults(const std::vector<std::filesystem::path> &searchResults,
-                                          const std::wstring &search) {
+void FinderOutputWidget::setSearchResults(const std::shared_ptr<const SearchResult> &results) {
 
   if (QThread::currentThread() != this->thread()) {
-    auto searchResultsCopy = searchResults;  // make a copy
-    auto searchCopy = search;                // make a copy
-    numQueuedProcesses.fetch_add(1);
+    // only the reference is passed on, the results themselves are never copied
     QMetaObject::invokeMethod(
-        this,
-        [this, searchResultsCopy, searchCopy]() {
-          numQueuedProcesses.fetch_sub(1);
-          setSearchResults(searchResultsCopy, searchCopy);
-        },
-        Qt::QueuedConnection);
+        this, [this, results]() { setSearchResults(results); }, Qt::QueuedConnection);
     return;
   }
 
   // this will always be executed by QThread main. So no multithreading or painting problems here.
-
-  resultList->clear(searchResults.size());
-  resultList->setSearchInput(search);
-
-  for (const auto &result : searchResults) {
-    if (numQueuedProcesses.load() > 0) {
-      return;  // we have new data
-    }
-    resultList->addSearchResultItem(result);
-  }
+  INSTRUMENT_SCOPE(UI_UPDATE);
+  // Every update only describes the changes against the previous one, none may be skipped.
+  resultModel->applyUpdate(results);
 }
 
 void FinderOutputWidget::reset() {
@@ -96,7 +88,7 @@ void FinderOutputWidget::reset() {
         this, [this]() { reset(); }, Qt::QueuedConnection);
     return;
   }
-  resultList->clear(0);
+  resultModel->clear();
 }
 
 void FinderOutputWidget::changeScale(const double scaleFactor) {
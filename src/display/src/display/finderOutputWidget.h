@@ -1,6 +1,7 @@
 #pragma once
 
 #include <display/HoverableListWidget.h>
+#include <display/SearchResultModel.h>
 
 #include <QGroupBox>
 #include <QLineEdit>
@@ -8,9 +9,9 @@
 #include <QObject>
 #include <QTextEdit>
 #include <QWidget>
-#include <atomic>
 #include <filesystem>
 #include <functional>
+#include <memory>
 
 class DisplayQt;
 
@@ -25,8 +26,7 @@ class FinderOutputWidget : public QWidget {
 
   void reset();
 
-  void setSearchResults(const std::vector<std::filesystem::path> &searchResults,
-                        const std::wstring &search);
+  void setSearchResults(const std::shared_ptr<const SearchResult> &results);
   void changeScale(const double scaleFactor);
 
  protected:
@@ -36,7 +36,6 @@ class FinderOutputWidget : public QWidget {
   QGroupBox *create_search();
   QGroupBox *create_resultField();
   HoverableListWidget *resultList;
+  SearchResultModel *resultModel;
   DisplayQt *displayQt;
-
-  std::atomic<int> numQueuedProcesses = 0;
 };
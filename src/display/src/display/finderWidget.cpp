@@ -35,6 +35,7 @@ QGroupBox *FinderWidget::create_info() {
   rootPathLabel->setWordWrap(true);
   formLayout->addRow(new QLabel("Files Found:"), filesFoundLabel);
   formLayout->addRow(new QLabel("Indexing Date:"), indexingDate);
+  formLayout->addRow(new QLabel("Index Memory:"), indexMemoryLabel);
 
   infoGroup->setLayout(formLayout);
   return infoGroup;
@@ -196,11 +197,12 @@ QGroupBox *FinderWidget::create_controlls() {
   return controlsGroup;
 }
 
-void FinderWidget::reset() { updateInfo(rootpath_default, 0, L"-"); }
+void FinderWidget::reset() { updateInfo(rootpath_default, 0, L"-", IndexStatistics()); }
 
 void FinderWidget::updateInfo(const std::wstring &root_path,
                               const size_t num_files,
-                              const std::wstring &indexing_date) {
+                              const std::wstring &indexing_date,
+                              const IndexStatistics &statistics) {
   // Ensure this runs in the main thread
   if (QThread::currentThread() != this->thread()) {
     // Make copies of the arguments and invoke method in the main thread
@@ -209,8 +211,8 @@ void FinderWidget::updateInfo(const std::wstring &root_path,
 
     QMetaObject::invokeMethod(
         this,
-        [this, root_path_copy, num_files, indexing_date_copy]() {
-          updateInfo(root_path_copy, num_files, indexing_date_copy);
+        [this, root_path_copy, num_files, indexing_date_copy, statistics]() {
+          updateInfo(root_path_copy, num_files, indexing_date_copy, statistics);
         },
         Qt::QueuedConnection);
     return;
@@ -224,4 +226,15 @@ void FinderWidget::updateInfo(const std::wstring &root_path,
   // rootPathLabel->setText(QString("Root Path: %1").arg(QString::fromStdWString(root_path)));
   filesFoundLabel->setText(QString("Files Found: %1").arg(QString::number(num_files)));
   indexingDate->setText(QString::fromStdWString(indexing_date));
+  if (statistics.numEntries == 0) {
+    indexMemoryLabel->setText("-");
+  } else {
+    constexpr double MB = 1024. * 1024.;
+    indexMemoryLabel->setText(QString("%1 MB, %2 bytes/entry")
+                                .arg(statistics.bytes.getTotal() / MB, 0, 'f', 1)
+                                .arg(statistics.getBytesPerEntry(), 0, 'f', 1));
+  }
+  // the breakdown and the histograms on hover
+  indexMemoryLabel->setToolTip(
+    QString("<pre>%1</pre>").arg(QString::fromStdString(statistics.toString()).toHtmlEscaped()));
 }
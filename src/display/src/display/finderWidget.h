@@ -1,5 +1,7 @@
 #pragma once
 
+#include <finder/IndexStatistics.h>
+
 #include <QGroupBox>
 #include <QLabel>
 #include <QLineEdit>
@@ -21,7 +23,8 @@ class FinderWidget : public QWidget {
 
   void updateInfo(const std::wstring &root_path,
                   const size_t num_files,
-                  const std::wstring &indexing_date);
+                  const std::wstring &indexing_date,
+                  const IndexStatistics &statistics);
 
 
 
@@ -36,4 +39,5 @@ class FinderWidget : public QWidget {
   QLabel *rootPathLabel = new QLabel();
   QLabel *filesFoundLabel = new QLabel();
   QLabel *indexingDate = new QLabel();
+  QLabel *indexMemoryLabel = new QLabel();
 };
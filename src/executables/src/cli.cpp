@@ -0,0 +1,442 @@
+// Headless front end of the finder: index or load, search, print. No display needed.
+#include <finder/DaemonProtocol.h>
+#include <finder/Finder.h>
+#include <finder/LocalSocket.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <globals/timer.hpp>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum class OutputFormat { LINES, NUL, JSON };
+
+struct Options {
+  std::filesystem::path root;
+  std::filesystem::path loadFile;
+  std::filesystem::path saveFile;
+  std::vector<std::wstring> queries;
+  bool readStdin      = false;
+  OutputFormat format = OutputFormat::LINES;
+  size_t limit        = 0;  // 0: print all results
+  bool printTiming    = false;
+  bool printStats     = false;
+  // the most common extensions of the results
+  bool printFacets = false;
+  // per query, 0: unlimited
+  size_t timeLimitMs = 0;
+  size_t maxNodes    = 0;
+  // search through a running fscoutd instead of indexing here
+  bool useDaemon = false;
+  std::filesystem::path daemonSocket = getDefaultDaemonSocket();
+};
+
+void printUsage(const char* name) {
+  std::cerr
+    << "Usage: " << name << " (--root <folder> | --load <index>) [options] [query...]\n"
+    << "       " << name << " --daemon --root <folder> [options] [query...]\n"
+    << "\n"
+    << "  -r, --root <folder>   index the folder\n"
+    << "  -l, --load <index>    load an index file instead of indexing\n"
+    << "  -s, --save <index>    write the index into a file before searching\n"
+    << "  -i, --stdin           read one query per line from stdin\n"
+    << "  -j, --json            print one json object per query\n"
+    << "  -0, --null            terminate every path by NUL instead of a newline\n"
+    << "  -n, --limit <n>       print the n best results per query, found best-first\n"
+    << "  -t, --time            print the time of every query to stderr\n"
+    << "      --stats           print the size and memory of the index to stderr\n"
+    << "      --facets          print the most common extensions of the results\n"
+    << "      --time-limit <ms> stop a search after ms and print the best results so far\n"
+    << "      --max-nodes <n>   stop a search after visiting n index nodes\n"
+    << "  -d, --daemon          let fscoutd search, it keeps the index in memory\n"
+    << "  -S, --socket <file>   socket of fscoutd (default " << getDefaultDaemonSocket().string()
+    << ")\n"
+    << "  -h, --help            show this help\n"
+    << "\n"
+    << "Without queries the index is only built (and saved).\n"
+    << "Terms like ext:cpp,h or *.cpp in a query filter the files by extension,\n"
+    << "size:>100m or modified:<7d by size and age. sort:size and sort:modified rank\n"
+    << "the largest or newest first.\n";
+}
+
+std::wstring fromUtf8(const std::string& str) {
+  return std::filesystem::path(std::u8string(str.begin(), str.end())).wstring();
+}
+
+std::string toUtf8(const std::filesystem::path& path) {
+  const std::u8string utf8 = path.u8string();
+  return std::string(utf8.begin(), utf8.end());
+}
+
+std::string jsonEscape(const std::string& str) {
+  std::string escaped;
+  escaped.reserve(str.size() + 2);
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char code[8];
+          std::snprintf(code, sizeof(code), "\\u%04x", c);
+          escaped += code;
+        } else {
+          escaped += c;
+        }
+    }
+  }
+  return escaped;
+}
+
+std::optional<Options> parseArguments(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    auto value            = [&]() -> std::optional<std::string> {
+      if (i + 1 >= argc) {
+        std::cerr << "Missing value for " << arg << std::endl;
+        return std::nullopt;
+      }
+      return std::string(argv[++i]);
+    };
+
+    if (arg == "-h" || arg == "--help") {
+      return std::nullopt;
+    } else if (arg == "-r" || arg == "--root") {
+      const auto root = value();
+      if (!root) {
+        return std::nullopt;
+      }
+      options.root = fromUtf8(*root);
+    } else if (arg == "-l" || arg == "--load") {
+      const auto file = value();
+      if (!file) {
+        return std::nullopt;
+      }
+      options.loadFile = fromUtf8(*file);
+    } else if (arg == "-s" || arg == "--save") {
+      const auto file = value();
+      if (!file) {
+        return std::nullopt;
+      }
+      options.saveFile = fromUtf8(*file);
+    } else if (arg == "-n" || arg == "--limit" || arg == "--time-limit" || arg == "--max-nodes") {
+      const auto limit = value();
+      if (!limit) {
+        return std::nullopt;
+      }
+      size_t& option = arg == "--time-limit" ? options.timeLimitMs
+                       : arg == "--max-nodes" ? options.maxNodes
+                                              : options.limit;
+      try {
+        option = std::stoul(*limit);
+      } catch (const std::exception&) {
+        std::cerr << "Invalid value for " << arg << ": " << *limit << std::endl;
+        return std::nullopt;
+      }
+    } else if (arg == "-i" || arg == "--stdin") {
+      options.readStdin = true;
+    } else if (arg == "-j" || arg == "--json") {
+      options.format = OutputFormat::JSON;
+    } else if (arg == "-0" || arg == "--null") {
+      options.format = OutputFormat::NUL;
+    } else if (arg == "-t" || arg == "--time") {
+      options.printTiming = true;
+    } else if (arg == "--stats") {
+      options.printStats = true;
+    } else if (arg == "--facets") {
+      options.printFacets = true;
+    } else if (arg == "-d" || arg == "--daemon") {
+      options.useDaemon = true;
+    } else if (arg == "-S" || arg == "--socket") {
+      const auto socket = value();
+      if (!socket) {
+        return std::nullopt;
+      }
+      options.daemonSocket = fromUtf8(*socket);
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      std::cerr << "Unknown option " << arg << std::endl;
+      return std::nullopt;
+    } else {
+      options.queries.push_back(fromUtf8(arg));
+    }
+  }
+
+  if (options.root.empty() == options.loadFile.empty()) {
+    std::cerr << "Give either a folder to index or an index file to load." << std::endl;
+    return std::nullopt;
+  }
+  if (options.useDaemon &&
+      (options.root.empty() || !options.saveFile.empty() || options.printStats)) {
+    std::cerr << "The daemon needs the root to search, it keeps the index and its statistics." << std::endl;
+    return std::nullopt;
+  }
+  if (options.useDaemon && (options.timeLimitMs > 0 || options.maxNodes > 0)) {
+    std::cerr << "The daemon searches with its own time limit settings." << std::endl;
+    return std::nullopt;
+  }
+  if (options.useDaemon && options.printFacets) {
+    std::cerr << "The daemon sends no extension counts." << std::endl;
+    return std::nullopt;
+  }
+  return options;
+}
+
+bool buildIndex(Finder& finder, const std::filesystem::path& root) {
+  if (!std::filesystem::is_directory(root)) {
+    std::cerr << "Not a folder: " << toUtf8(root) << std::endl;
+    return false;
+  }
+  // the callback runs on the indexing thread and is called for progress as well
+  auto indexed  = std::make_shared<std::promise<bool>>();
+  auto reported = std::make_shared<bool>(false);
+  auto result   = indexed->get_future();
+  finder.setRootPath(
+    root, [indexed, reported](const bool success, const bool finished, const std::wstring& msg) {
+      if (*reported || (success && !finished)) {
+        return;
+      }
+      *reported = true;
+      if (!success) {
+        std::wcerr << L"Indexing failed: " << msg << std::endl;
+      }
+      indexed->set_value(success);
+    });
+  return result.get();
+}
+
+bool saveIndex(Finder& finder, const std::filesystem::path& file) {
+  std::promise<bool> saved;
+  const bool started =
+    finder.saveCurrentIndex(file, [&](const bool success, const std::wstring& msg) {
+      if (!success) {
+        std::wcerr << L"Saving failed: " << msg << std::endl;
+      }
+      saved.set_value(success);
+    });
+  return started && saved.get_future().get();
+}
+
+void printResults(const std::wstring& query,
+                  const std::vector<std::string>& paths,
+                  const size_t numResults,
+                  const bool incomplete,
+                  const std::vector<ExtensionCount>& extensionCounts,
+                  const double time_ms,
+                  const Options& options) {
+  if (options.format == OutputFormat::JSON) {
+    std::cout << "{\"query\":\"" << jsonEscape(toUtf8(query)) << "\",\"time_ms\":" << time_ms
+              << ",\"count\":" << numResults
+              << ",\"incomplete\":" << (incomplete ? "true" : "false");
+    if (options.printFacets) {
+      std::cout << ",\"extensions\":{";
+      for (size_t i = 0; i < extensionCounts.size(); ++i) {
+        std::cout << (i == 0 ? "\"" : ",\"") << jsonEscape(toUtf8(extensionCounts[i].extension))
+                  << "\":" << extensionCounts[i].count;
+      }
+      std::cout << '}';
+    }
+    std::cout << ",\"results\":[";
+    for (size_t i = 0; i < paths.size(); ++i) {
+      std::cout << (i == 0 ? "\"" : ",\"") << jsonEscape(paths[i]) << '"';
+    }
+    std::cout << "]}\n";
+  } else {
+    const char terminator = options.format == OutputFormat::NUL ? '\0' : '\n';
+    for (const auto& path : paths) {
+      std::cout << path << terminator;
+    }
+  }
+  std::cout.flush();
+
+  if (options.printTiming) {
+    std::cerr << toUtf8(query) << ": " << numResults << " results in " << time_ms << " ms"
+              << (incomplete ? ", out of budget" : "") << std::endl;
+  } else if (incomplete) {
+    std::cerr << toUtf8(query) << ": out of budget, the results are incomplete" << std::endl;
+  }
+  if (options.printFacets && options.format != OutputFormat::JSON) {
+    std::cerr << toUtf8(query) << ":";
+    for (const ExtensionCount& facet : extensionCounts) {
+      std::cerr << " ." << toUtf8(facet.extension) << " " << facet.count;
+    }
+    std::cerr << std::endl;
+  }
+}
+
+size_t getNumPrinted(const size_t numResults, const Options& options) {
+  return options.limit == 0 ? numResults : std::min(options.limit, numResults);
+}
+
+bool runQuery(Finder& finder, const std::wstring& query, const Options& options) {
+  auto finished = std::make_shared<std::promise<std::shared_ptr<const SearchResult>>>();
+  auto future   = finished->get_future();
+
+  Timer timer;
+  timer.start();
+  std::optional<SearchBudget> budget;
+  if (options.timeLimitMs > 0 || options.maxNodes > 0) {
+    budget = SearchBudget::fromNow(std::chrono::milliseconds(options.timeLimitMs), options.maxNodes);
+  }
+  finder.search(
+    query,
+    [finished](const std::shared_ptr<const SearchResult>& results) {
+      if (results->finished) {
+        finished->set_value(results);  // the last call of a search
+      }
+    },
+    budget,
+    options.limit);  // with a limit only the best results are searched for
+  const auto results   = future.get();
+  const double time_ms = timer.getPassedTime<std::chrono::microseconds>().count() / 1000.;
+
+  // only the printed paths are decoded
+  const std::vector<EntryId>& ranking = results->update.ranking;
+  std::vector<std::string> paths(getNumPrinted(ranking.size(), options));
+  for (size_t i = 0; i < paths.size(); ++i) {
+    paths[i] = toUtf8(results->dictionary->getPath(ranking[i]));
+  }
+  printResults(
+    query, paths, ranking.size(), results->incomplete, results->extensionCounts, time_ms, options);
+  return true;
+}
+
+/*!
+ * \brief Search through fscoutd.
+ * \param shownPaths The results of the previous query on this connection, the daemon
+ * sends the changes against them.
+ */
+bool runDaemonQuery(LocalSocket& daemon,
+                    std::vector<std::string>& shownPaths,
+                    const std::wstring& query,
+                    const Options& options) {
+  Timer timer;
+  timer.start();
+  BinaryWriter request;
+  writeSearchRequest(request, options.root, query);
+  if (!daemon.send(request)) {
+    std::cerr << "Lost the connection to fscoutd" << std::endl;
+    return false;
+  }
+
+  std::vector<char> message;
+  bool finished = false;
+  while (!finished) {
+    if (!daemon.receive(message)) {
+      std::cerr << "Lost the connection to fscoutd" << std::endl;
+      return false;
+    }
+    try {
+      BinaryReader reader(message.data(), message.size());
+      if (readDaemonMessageType(reader) == DaemonMessage::ERROR) {
+        std::cerr << "fscoutd: " << readError(reader) << std::endl;
+        return false;
+      }
+      finished = readResults(reader, shownPaths);
+    } catch (const std::runtime_error& e) {
+      std::cerr << "Invalid answer of fscoutd: " << e.what() << std::endl;
+      return false;
+    }
+  }
+  const double time_ms = timer.getPassedTime<std::chrono::microseconds>().count() / 1000.;
+
+  const std::vector<std::string> paths(
+    shownPaths.begin(), shownPaths.begin() + getNumPrinted(shownPaths.size(), options));
+  printResults(query, paths, shownPaths.size(), false, {}, time_ms, options);
+  return true;
+}
+
+/*!
+ * \brief Run the queries of the command line, then the ones from stdin if requested.
+ */
+bool runQueries(const Options& options, const std::function<bool(const std::wstring&)>& run) {
+  for (const auto& query : options.queries) {
+    if (!run(query)) {
+      return false;
+    }
+  }
+  if (options.readStdin) {
+    std::string line;
+    while (std::getline(std::cin, line)) {
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+      if (!line.empty() && !run(fromUtf8(line))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const auto options = parseArguments(argc, argv);
+  if (!options) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  if (options->useDaemon) {
+    LocalSocket daemon;
+    try {
+      daemon = LocalSocket::connect(options->daemonSocket);
+    } catch (const std::runtime_error& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    std::vector<std::string> shownPaths;
+    const bool success = runQueries(*options, [&](const std::wstring& query) {
+      return runDaemonQuery(daemon, shownPaths, query, *options);
+    });
+    return success ? 0 : 1;
+  }
+
+  // the settings and cached indexes of the GUI are used, but never changed
+  Finder finder(Finder::Persistence::READ_ONLY);
+  Timer timer;
+  timer.start();
+  if (!options->loadFile.empty()) {
+    if (!finder.loadIndexFromFile(options->loadFile)) {
+      return 1;
+    }
+  } else if (!buildIndex(finder, options->root)) {
+    return 1;
+  }
+  if (options->printTiming) {
+    std::cerr << (options->loadFile.empty() ? "indexed " : "loaded ") << finder.getNumEntries()
+              << " entries in " << timer.getPassedTime<std::chrono::milliseconds>().count()
+              << " ms" << std::endl;
+  }
+  if (options->printStats) {
+    std::cerr << finder.getIndexStatistics().toString();
+  }
+
+  if (!options->saveFile.empty() && !saveIndex(finder, options->saveFile)) {
+    return 1;
+  }
+
+  const bool success = runQueries(
+    *options, [&](const std::wstring& query) { return runQuery(finder, query, *options); });
+  return success ? 0 : 1;
+}
@@ -0,0 +1,346 @@
+// fscoutd: keeps the index of every requested root in memory and answers searches
+// over a local socket. All tools of a user share one index per root this way.
+#include <finder/DaemonProtocol.h>
+#include <finder/Finder.h>
+#include <finder/LocalSocket.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <future>
+#include <globals/instrumentation.hpp>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<bool> stopRequested = false;
+std::atomic<bool> dumpRequested = false;
+
+void requestStop(int) { stopRequested = true; }
+void requestDump(int) { dumpRequested = true; }
+
+struct Options {
+  std::filesystem::path socket = getDefaultDaemonSocket();
+  std::vector<std::filesystem::path> roots;
+  std::chrono::minutes reindexInterval{10};
+};
+
+/*!
+ * \brief The index of one root. Searches on it run one after the other, a Finder
+ * cancels its running search when the next one starts.
+ */
+struct RootIndex {
+  // Reads the cached index of the GUI, but leaves its settings and cache alone:
+  // the daemon's own index lives in memory.
+  Finder finder{Finder::Persistence::READ_ONLY};
+  std::mutex searchMutex;
+  // set once the root is searchable for the first time (or failed to get there)
+  std::promise<bool> loaded;
+  std::shared_future<bool> ready = loaded.get_future().share();
+  std::once_flag loadedOnce;
+  std::atomic<std::chrono::steady_clock::time_point> lastIndexed{};
+};
+
+/*!
+ * \brief The results of one search streamed to a client.
+ */
+struct SearchStream {
+  std::mutex mutex;
+  bool connected = true;
+  // the client got an answer already, later results are dropped
+  bool abandoned = false;
+};
+
+struct Client {
+  std::thread thread;
+  std::shared_ptr<LocalSocket> connection;
+  std::shared_ptr<std::atomic<bool>> done = std::make_shared<std::atomic<bool>>(false);
+};
+
+class Daemon {
+ public:
+  explicit Daemon(const Options& options)
+      : options(options) {}
+
+  int run() {
+    LocalSocket server;
+    try {
+      server = LocalSocket::listen(options.socket);
+    } catch (const std::runtime_error& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    std::cerr << "fscoutd listening on " << options.socket.string() << std::endl;
+
+    for (const auto& root : options.roots) {
+      getRoot(root, false);
+    }
+
+    std::vector<Client> clients;
+    auto lastFreshnessCheck = std::chrono::steady_clock::now();
+    while (!stopRequested) {
+      LocalSocket connection = server.accept(POLL_INTERVAL_MS);
+      if (connection.isValid()) {
+        Client client;
+        client.connection = std::make_shared<LocalSocket>(std::move(connection));
+        client.thread     = std::thread([this, connection = client.connection, done = client.done]() {
+          serve(*connection);
+          *done = true;
+        });
+        clients.push_back(std::move(client));
+      }
+      joinFinishedClients(clients);
+
+      if (dumpRequested.exchange(false)) {
+        instrumentation::dump(std::cerr);
+      }
+
+      if (std::chrono::steady_clock::now() - lastFreshnessCheck > FRESHNESS_CHECK_INTERVAL) {
+        lastFreshnessCheck = std::chrono::steady_clock::now();
+        reindexOutdatedRoots();
+      }
+    }
+
+    std::cerr << "fscoutd shutting down" << std::endl;
+    server.close();
+    for (auto& client : clients) {
+      client.connection->shutdown();  // wakes up clients waiting for their next request
+      client.thread.join();
+    }
+    return 0;
+  }
+
+ private:
+  static constexpr int POLL_INTERVAL_MS = 500;
+  static constexpr std::chrono::milliseconds SEARCH_POLL_INTERVAL{100};
+  static constexpr std::chrono::seconds FRESHNESS_CHECK_INTERVAL{30};
+
+  static void joinFinishedClients(std::vector<Client>& clients) {
+    for (auto client = clients.begin(); client != clients.end();) {
+      if (*client->done) {
+        client->thread.join();
+        client = clients.erase(client);
+      } else {
+        ++client;
+      }
+    }
+  }
+
+  /*!
+   * \brief Get the index of a root. A root requested for the first time gets its cached
+   * index loaded (if any) and is crawled afterwards.
+   * \param wait Block until the root is searchable.
+   */
+  RootIndex* getRoot(const std::filesystem::path& path, const bool wait) {
+    std::error_code ec;
+    const std::filesystem::path root = std::filesystem::weakly_canonical(path, ec);
+    if (ec || !std::filesystem::is_directory(root)) {
+      return nullptr;
+    }
+
+    RootIndex* index = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(rootsMutex);
+      auto& known = roots[root];
+      if (!known) {
+        known = std::make_unique<RootIndex>();
+        known->finder.loadCachedIndex(
+          root, [index = known.get()](const bool success, const bool finished, const std::wstring& msg) {
+            if (success && !finished) {
+              return;
+            }
+            if (!success) {
+              std::wcerr << L"Indexing failed: " << msg << std::endl;
+            }
+            // called after loading the cache and again after crawling
+            index->lastIndexed = std::chrono::steady_clock::now();
+            std::call_once(index->loadedOnce, [&]() { index->loaded.set_value(success); });
+          });
+      }
+      index = known.get();
+    }
+    if (wait) {
+      index->ready.wait();
+    }
+    return index;
+  }
+
+  /*!
+   * \brief Crawl every root again once its index is older than the reindex interval.
+   * The old index answers searches until the new one is complete.
+   */
+  void reindexOutdatedRoots() {
+    std::lock_guard<std::mutex> lock(rootsMutex);
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& [root, index] : roots) {
+      if (index->finder.isIndexing() || !index->finder.isInitiated() ||
+          now - index->lastIndexed.load() < options.reindexInterval) {
+        continue;
+      }
+      std::wcerr << L"Reindexing " << root.wstring() << std::endl;
+      index->finder.reindex(
+        [index = index.get()](const bool success, const bool finished, const std::wstring&) {
+          if (!success || finished) {
+            index->lastIndexed = std::chrono::steady_clock::now();
+          }
+        });
+    }
+  }
+
+  void serve(LocalSocket& connection) {
+    // the ranking this client shows, results are sent as changes against it
+    const RootIndex* shownRoot = nullptr;
+    uint64_t shownVersion      = 0;
+
+    std::vector<char> message;
+    while (!stopRequested && connection.receive(message)) {
+      std::filesystem::path root;
+      std::wstring needle;
+      try {
+        BinaryReader reader(message.data(), message.size());
+        if (readDaemonMessageType(reader) != DaemonMessage::SEARCH) {
+          throw std::runtime_error("Expected a search request");
+        }
+        readSearchRequest(reader, root, needle);
+      } catch (const std::runtime_error& e) {
+        BinaryWriter error;
+        writeError(error, e.what());
+        connection.send(error);
+        return;
+      }
+
+      RootIndex* index = getRoot(root, true);
+      if (index == nullptr) {
+        BinaryWriter error;
+        writeError(error, "Not a folder: " + root.string());
+        if (!connection.send(error)) {
+          return;
+        }
+        continue;
+      }
+      if (index != shownRoot) {
+        shownRoot    = index;
+        shownVersion = 0;
+      }
+
+      std::lock_guard<std::mutex> lock(index->searchMutex);
+      auto finished = std::make_shared<std::promise<void>>();
+      auto done     = finished->get_future();
+      // shared with the callback: a search given up on below may still call it
+      auto stream = std::make_shared<SearchStream>();
+      // partial results are streamed as the finder reports them
+      index->finder.search(
+        needle,
+        [&connection, &shownVersion, stream, finished](const std::shared_ptr<const SearchResult>& results) {
+          std::lock_guard<std::mutex> streamLock(stream->mutex);
+          if (stream->abandoned) {
+            return;
+          }
+          if (stream->connected) {
+            const ResultUpdate& update = results->update;
+            stream->connected          = writeResults(
+              *results, !update.appliesTo(shownVersion), [&connection](const BinaryWriter& message) {
+                return connection.send(message);
+              });
+            shownVersion = update.version;
+          }
+          if (results->finished) {
+            finished->set_value();
+          }
+        });
+      // A cancelled search (the root got reloaded) never sends finished results,
+      // it is noticed by the finder not searching anymore.
+      while (done.wait_for(SEARCH_POLL_INTERVAL) != std::future_status::ready) {
+        if (!index->finder.isSearching() || stopRequested) {
+          break;
+        }
+      }
+      bool completed = false;
+      bool connected = false;
+      {
+        std::lock_guard<std::mutex> streamLock(stream->mutex);
+        stream->abandoned = true;
+        completed = done.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        connected = stream->connected;
+      }
+      if (!connected) {
+        return;
+      }
+      if (!completed) {
+        BinaryWriter error;
+        writeError(error, "The search was cancelled");
+        if (!connection.send(error)) {
+          return;
+        }
+      }
+    }
+  }
+
+  const Options options;
+  std::mutex rootsMutex;
+  std::map<std::filesystem::path, std::unique_ptr<RootIndex>> roots;
+};
+
+void printUsage(const char* name) {
+  std::cerr << "Usage: " << name << " [options] [root...]\n"
+            << "\n"
+            << "Keeps the index of every root in memory and answers searches of\n"
+            << "fscout-cli --daemon. Roots given here are indexed right away,\n"
+            << "others on their first search.\n"
+            << "\n"
+            << "  -S, --socket <file>       listen on this socket (default "
+            << getDefaultDaemonSocket().string() << ")\n"
+            << "  -R, --reindex <minutes>   crawl every root again after this long (default 10)\n"
+            << "  -h, --help                show this help\n";
+}
+
+std::optional<Options> parseArguments(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      return std::nullopt;
+    } else if ((arg == "-S" || arg == "--socket") && i + 1 < argc) {
+      options.socket = argv[++i];
+    } else if ((arg == "-R" || arg == "--reindex") && i + 1 < argc) {
+      try {
+        options.reindexInterval = std::chrono::minutes(std::stoul(argv[++i]));
+      } catch (const std::exception&) {
+        std::cerr << "Invalid interval " << argv[i] << std::endl;
+        return std::nullopt;
+      }
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      std::cerr << "Unknown or incomplete option " << arg << std::endl;
+      return std::nullopt;
+    } else {
+      options.roots.emplace_back(arg);
+    }
+  }
+  return options;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const auto options = parseArguments(argc, argv);
+  if (!options) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  std::signal(SIGINT, requestStop);
+  std::signal(SIGTERM, requestStop);
+  std::signal(SIGPIPE, SIG_IGN);
+  // prints the timings of an instrumented build
+  std::signal(SIGUSR1, requestDump);
+
+  return Daemon(*options).run();
+}
@@ -0,0 +1,243 @@
+// libFuzzer harness for Dictionary::search, built with FUZZER_ENABLED.
+//
+// fuzz_search builds a small index from the input and compares the results of a random
+// needle (wildcards, fuzzy replacements) with a brute force oracle, for the depth-first
+// search and the best-first search for the top results.
+// fuzz_search_worst_case (FUZZ_WORST_CASE) instead looks for inputs that make the
+// search visit many tree nodes. Every new power of two of visited nodes is new coverage
+// for libFuzzer, so it keeps climbing. Inputs above FUZZ_MAX_NODES_VISITED (default
+// 1000000) are reported as crash, e.g.
+//   FUZZ_MAX_NODES_VISITED=100000 fuzz_search_worst_case -max_len=2048 corpus/
+#include <finder/Dictionary.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// few letters, so names share prefixes and needles match often
+constexpr std::array<wchar_t, 4> NAME_LETTERS = {L'a', L'b', L'c', L'-'};
+constexpr wchar_t WILDCARD                    = L'*';
+
+#ifdef FUZZ_WORST_CASE
+constexpr size_t MAX_NAMES       = 256;
+constexpr size_t MAX_NAME_LENGTH = 32;
+constexpr size_t MAX_NEEDLE      = 16;
+#else
+constexpr size_t MAX_NAMES       = 32;
+constexpr size_t MAX_NAME_LENGTH = 12;
+constexpr size_t MAX_NEEDLE      = 8;
+#endif
+// the most the Finder uses
+constexpr size_t MAX_FUZZY_REPLACEMENTS = 2;
+
+/*!
+ * \brief Takes the fuzzer input apart, returns zeros once it is used up.
+ */
+class InputReader {
+ public:
+  InputReader(const uint8_t* data, const size_t size)
+      : data(data),
+        size(size) {}
+
+  uint8_t next() { return position < size ? data[position++] : 0; }
+
+  bool empty() const { return position >= size; }
+
+  std::wstring nextString(const size_t maxLength, const bool withWildcard) {
+    std::wstring str(next() % (maxLength + 1), L' ');
+    for (auto& c : str) {
+      const uint8_t letter = next();
+      c = withWildcard && letter % 8 == 0 ? WILDCARD : NAME_LETTERS[letter % NAME_LETTERS.size()];
+    }
+    return str;
+  }
+
+ private:
+  const uint8_t* data;
+  const size_t size;
+  size_t position = 0;
+};
+
+/*!
+ * \brief The fewest edits (replace, insert, delete) turning the needle into a substring
+ * of name. A wildcard in the needle matches any character.
+ */
+size_t getSubstringDistance(const std::wstring& needle, const std::wstring& name, const bool useWildcard) {
+  // row i: the needle up to i against the name up to j, starting anywhere in the name
+  std::vector<size_t> previous(name.size() + 1, 0);
+  std::vector<size_t> current(name.size() + 1);
+  for (size_t i = 1; i <= needle.size(); ++i) {
+    current[0] = i;
+    for (size_t j = 1; j <= name.size(); ++j) {
+      const bool same = needle[i - 1] == name[j - 1] || (useWildcard && needle[i - 1] == WILDCARD);
+      current[j] = std::min({previous[j - 1] + (same ? 0 : 1), previous[j] + 1, current[j - 1] + 1});
+    }
+    std::swap(previous, current);
+  }
+  return *std::min_element(previous.begin(), previous.end());
+}
+
+#ifdef FUZZ_WORST_CASE
+size_t getMaxNodesVisited() {
+  const char* max = std::getenv("FUZZ_MAX_NODES_VISITED");
+  return max != nullptr ? std::strtoull(max, nullptr, 10) : 1000000;
+}
+
+// one function per power of two, each is an edge of its own for the coverage
+template <size_t MAGNITUDE>
+__attribute__((noinline)) void reachMagnitude() {
+  asm volatile("");
+}
+
+template <size_t... MAGNITUDES>
+void reportMagnitude(const size_t magnitude, std::index_sequence<MAGNITUDES...>) {
+  constexpr std::array<void (*)(), sizeof...(MAGNITUDES)> reached = {
+    &reachMagnitude<MAGNITUDES>...};
+  reached[std::min(magnitude, reached.size() - 1)]();
+}
+#endif
+
+}  // namespace
+
+#ifndef FUZZ_WORST_CASE
+/*!
+ * \brief The best-first search finds everything within the fuzzy replacements, or at
+ * least the maxResults best scored ones of it.
+ */
+void checkBestFirst(const Dictionary& dictionary,
+                    const std::map<EntryId, std::wstring>& names,
+                    const std::wstring& needle,
+                    const size_t numFuzzyReplacements,
+                    const bool useWildcard,
+                    const size_t maxResults) {
+  std::atomic<bool> stop = false;
+  std::vector<EntryId> matches;
+  dictionary.searchBest(
+    stop,
+    needle,
+    numFuzzyReplacements,
+    useWildcard ? WILDCARD : Dictionary::NO_WILDCARD,
+    maxResults,
+    [](EntryId, const std::wstring&) { return true; },
+    matches);
+
+  const std::set<EntryId> found(matches.begin(), matches.end());
+  std::vector<int> foundScores;
+  for (const EntryId id : found) {
+    const auto name = names.find(id);
+    if (name == names.end() ||
+        getSubstringDistance(needle, name->second, useWildcard) > numFuzzyReplacements) {
+      fprintf(stderr, "Best-first found entry %u which does not match \"%ls\"\n", id, needle.c_str());
+      abort();
+    }
+    foundScores.push_back(Dictionary::scoreMatch(needle, name->second));
+  }
+  std::vector<int> expectedScores;
+  for (const auto& [id, name] : names) {
+    if (getSubstringDistance(needle, name, useWildcard) <= numFuzzyReplacements) {
+      expectedScores.push_back(Dictionary::scoreMatch(needle, name));
+    }
+  }
+  std::sort(foundScores.begin(), foundScores.end(), std::greater<int>());
+  std::sort(expectedScores.begin(), expectedScores.end(), std::greater<int>());
+  if (maxResults > 0 && expectedScores.size() > maxResults) {
+    expectedScores.resize(maxResults);
+    foundScores.resize(std::min(foundScores.size(), maxResults));
+  }
+  if (foundScores != expectedScores) {
+    fprintf(stderr,
+            "Best-first missed matches of \"%ls\": %zu best scores found, %zu expected\n",
+            needle.c_str(),
+            foundScores.size(),
+            expectedScores.size());
+    abort();
+  }
+}
+#endif
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  InputReader input(data, size);
+  const size_t numFuzzyReplacements = input.next() % (MAX_FUZZY_REPLACEMENTS + 1);
+  const bool useWildcard            = input.next() % 2 == 0;
+  const size_t maxResults           = input.next() % 4;  // 0: all
+  const std::wstring needle         = input.nextString(MAX_NEEDLE, useWildcard);
+
+  Dictionary dictionary;
+  std::map<EntryId, std::wstring> names;
+  const std::filesystem::path root = L"/fuzz";
+  for (size_t i = 0; i < MAX_NAMES && !input.empty(); ++i) {
+    std::wstring name = input.nextString(MAX_NAME_LENGTH, false);
+    if (name.empty()) {
+      continue;
+    }
+    // a folder every few names, so the entries are spread over some parents
+    const auto parent = root / std::to_wstring(i % 3);
+    names.emplace(dictionary.addPath(parent / name, false), std::move(name));
+  }
+  dictionary.finalize(false);
+
+  std::atomic<bool> stop = false;
+  std::vector<EntryId> matches;
+  const size_t nodesVisited =
+    dictionary
+      .search(stop, needle, numFuzzyReplacements, useWildcard ? WILDCARD : Dictionary::NO_WILDCARD, matches)
+      .nodesVisited;
+
+#ifdef FUZZ_WORST_CASE
+  static_cast<void>(maxResults);
+  reportMagnitude(std::bit_width(nodesVisited), std::make_index_sequence<64>());
+  static const size_t maxNodesVisited = getMaxNodesVisited();
+  static size_t mostNodesVisited      = 0;
+  if (nodesVisited > mostNodesVisited) {
+    mostNodesVisited = nodesVisited;
+    fprintf(stderr,
+            "%zu nodes visited for needle \"%ls\", %zu names, %zu fuzzy replacements\n",
+            nodesVisited,
+            needle.c_str(),
+            names.size(),
+            numFuzzyReplacements);
+  }
+  if (nodesVisited > maxNodesVisited) {
+    abort();
+  }
+#else
+  static_cast<void>(nodesVisited);
+  // the tree only holds entries, folders are not indexed here
+  const std::set<EntryId> found(matches.begin(), matches.end());
+  for (const EntryId id : found) {
+    const auto name = names.find(id);
+    if (name == names.end()) {
+      fprintf(stderr, "Unknown entry %u found\n", id);
+      abort();
+    }
+    // a result is never further away than the allowed replacements
+    if (getSubstringDistance(needle, name->second, useWildcard) > numFuzzyReplacements) {
+      fprintf(stderr, "\"%ls\" does not match \"%ls\"\n", name->second.c_str(), needle.c_str());
+      abort();
+    }
+  }
+  // exact searches find every match, the fuzzy search does not try every edit
+  if (numFuzzyReplacements == 0) {
+    for (const auto& [id, name] : names) {
+      if (getSubstringDistance(needle, name, useWildcard) == 0 && !found.contains(id)) {
+        fprintf(stderr, "\"%ls\" matches \"%ls\" but was not found\n", name.c_str(), needle.c_str());
+        abort();
+      }
+    }
+  }
+  checkBestFirst(dictionary, names, needle, numFuzzyReplacements, useWildcard, maxResults);
+#endif
+  return 0;
+}
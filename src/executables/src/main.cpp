@@ -42,7 +42,7 @@ int main(int argc, char* argv[]) {
   format.setSwapBehavior(QSurfaceFormat::DoubleBuffer);
   QSurfaceFormat::setDefaultFormat(format);
   mainWin.show();
-  /*
+#ifdef FSCOUT_INSTRUMENTATION
   QObject::connect(QAbstractEventDispatcher::instance(),
                    &QAbstractEventDispatcher::aboutToBlock,
                    []() { Globals::getFrameTimer().frameStart(); });
@@ -50,7 +50,6 @@ int main(int argc, char* argv[]) {
   QObject::connect(QAbstractEventDispatcher::instance(),
                    &QAbstractEventDispatcher::awake,
                    []() { Globals::getFrameTimer().frameStart(); });
-
-  */
+#endif
   return app.exec();
 }
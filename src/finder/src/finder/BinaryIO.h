@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/*!
+ * \brief Appends binary data to a byte buffer.
+ * Integers are written little endian as LEB128 varints where they are usually small.
+ */
+class BinaryWriter {
+ public:
+  template <class T>
+  void writePod(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const auto* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+  }
+
+  void writeVarint(uint64_t value) {
+    constexpr uint64_t SEVEN_BITS  = 0x7F;
+    constexpr uint8_t MORE_FOLLOWS = 0x80;
+    while (value > SEVEN_BITS) {
+      buffer.push_back(static_cast<char>((value & SEVEN_BITS) | MORE_FOLLOWS));
+      value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+  }
+
+  void writeBytes(const void* data, const size_t size) {
+    const auto* bytes = static_cast<const char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+  }
+
+  void writeString(std::string_view str) {
+    writeVarint(str.size());
+    writeBytes(str.data(), str.size());
+  }
+
+  const std::vector<char>& getBuffer() const { return buffer; }
+  std::vector<char>& getBuffer() { return buffer; }
+  size_t size() const { return buffer.size(); }
+
+ private:
+  std::vector<char> buffer;
+};
+
+/*!
+ * \brief Reads binary data written by the BinaryWriter.
+ * Every read is bounds checked: a truncated or corrupted buffer throws
+ * std::runtime_error instead of reading garbage.
+ */
+class BinaryReader {
+ public:
+  BinaryReader(const char* data, const size_t size)
+      : data(data), size(size) {}
+
+  template <class T>
+  T readPod() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    require(sizeof(T));
+    T value;
+    std::memcpy(&value, data + position, sizeof(T));
+    position += sizeof(T);
+    return value;
+  }
+
+  uint64_t readVarint() {
+    constexpr uint8_t SEVEN_BITS   = 0x7F;
+    constexpr uint8_t MORE_FOLLOWS = 0x80;
+    constexpr int MAX_SHIFT        = 63;
+    uint64_t value                 = 0;
+    for (int shift = 0; shift <= MAX_SHIFT; shift += 7) {
+      require(1);
+      const auto byte = static_cast<uint8_t>(data[position++]);
+      value |= static_cast<uint64_t>(byte & SEVEN_BITS) << shift;
+      if ((byte & MORE_FOLLOWS) == 0) {
+        return value;
+      }
+    }
+    throw std::runtime_error("Corrupted index: varint too long");
+  }
+
+  /*!
+   * \brief Read a count which is used for an allocation. Each counted element
+   * needs at least minBytesPerElement in the remaining buffer, so a garbage count
+   * is rejected before anything huge gets allocated.
+   */
+  size_t readCount(const size_t minBytesPerElement = 1) {
+    const uint64_t count = readVarint();
+    if (minBytesPerElement > 0 && count > remaining() / minBytesPerElement) {
+      throw std::runtime_error("Corrupted index: count exceeds the data");
+    }
+    return static_cast<size_t>(count);
+  }
+
+  std::string_view readBytes(const size_t numBytes) {
+    require(numBytes);
+    std::string_view bytes(data + position, numBytes);
+    position += numBytes;
+    return bytes;
+  }
+
+  std::string_view readString() { return readBytes(readCount()); }
+
+  size_t remaining() const { return size - position; }
+  size_t getPosition() const { return position; }
+  bool atEnd() const { return position == size; }
+
+ private:
+  void require(const size_t numBytes) const {
+    if (numBytes > remaining()) {
+      throw std::runtime_error("Corrupted index: unexpected end of data");
+    }
+  }
+
+  const char* data;
+  size_t size;
+  size_t position = 0;
+};
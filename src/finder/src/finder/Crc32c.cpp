@@ -0,0 +1,118 @@
+#include <finder/Crc32c.h>
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FSCOUT_CRC32C_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <nmmintrin.h>
+#else
+#include <cpuid.h>
+#include <nmmintrin.h>
+#endif
+#endif
+
+namespace {
+constexpr uint32_t CASTAGNOLI_POLYNOMIAL = 0x82F63B78;  // reversed
+constexpr size_t NUM_SLICES              = 8;
+
+using Tables = std::array<std::array<uint32_t, 256>, NUM_SLICES>;
+
+constexpr Tables makeTables() {
+  Tables tables{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CASTAGNOLI_POLYNOMIAL : 0);
+    }
+    tables[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; ++i) {
+    for (size_t slice = 1; slice < NUM_SLICES; ++slice) {
+      const uint32_t previous = tables[slice - 1][i];
+      tables[slice][i]        = (previous >> 8) ^ tables[0][previous & 0xFF];
+    }
+  }
+  return tables;
+}
+
+constexpr Tables TABLES = makeTables();
+
+inline uint32_t loadLittleEndian(const uint8_t* bytes) {
+  return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+         static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+#ifdef FSCOUT_CRC32C_X86
+#ifndef _MSC_VER
+__attribute__((target("sse4.2")))
+#endif
+uint32_t crc32cHardware(const uint8_t* bytes, size_t size, uint32_t crc) {
+  uint64_t crc64 = crc;
+  while (size >= sizeof(uint64_t)) {
+    uint64_t chunk;
+    std::memcpy(&chunk, bytes, sizeof(chunk));
+    crc64 = _mm_crc32_u64(crc64, chunk);
+    bytes += sizeof(uint64_t);
+    size -= sizeof(uint64_t);
+  }
+  auto crc32 = static_cast<uint32_t>(crc64);
+  while (size-- > 0) {
+    crc32 = _mm_crc32_u8(crc32, *bytes++);
+  }
+  return crc32;
+}
+
+bool detectSse42() {
+  constexpr int SSE42_BIT = 1 << 20;
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & SSE42_BIT) != 0;
+#else
+  unsigned int eax, ebx, ecx, edx;
+  return __get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 && (ecx & SSE42_BIT) != 0;
+#endif
+}
+#endif
+}  // namespace
+
+uint32_t crc32cSoftware(const void* data, size_t size, uint32_t crc) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  crc               = ~crc;
+  while (size >= NUM_SLICES) {
+    // assembled byte by byte to be independent of the endianess
+    const uint32_t low  = loadLittleEndian(bytes) ^ crc;
+    const uint32_t high = loadLittleEndian(bytes + 4);
+    crc = TABLES[7][low & 0xFF] ^ TABLES[6][(low >> 8) & 0xFF] ^
+          TABLES[5][(low >> 16) & 0xFF] ^ TABLES[4][low >> 24] ^
+          TABLES[3][high & 0xFF] ^ TABLES[2][(high >> 8) & 0xFF] ^
+          TABLES[1][(high >> 16) & 0xFF] ^ TABLES[0][high >> 24];
+    bytes += NUM_SLICES;
+    size -= NUM_SLICES;
+  }
+  while (size-- > 0) {
+    crc = (crc >> 8) ^ TABLES[0][(crc ^ *bytes++) & 0xFF];
+  }
+  return ~crc;
+}
+
+bool crc32cHardwareSupported() {
+#ifdef FSCOUT_CRC32C_X86
+  static const bool supported = detectSse42();
+  return supported;
+#else
+  return false;
+#endif
+}
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) {
+#ifdef FSCOUT_CRC32C_X86
+  if (crc32cHardwareSupported()) {
+    return ~crc32cHardware(static_cast<const uint8_t*>(data), size, ~crc);
+  }
+#endif
+  return crc32cSoftware(data, size, crc);
+}
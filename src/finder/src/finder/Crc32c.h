@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * \brief CRC32C (Castagnoli) checksum, as used by iSCSI, ext4 and btrfs.
+ * Uses the SSE4.2 crc32 instruction if the cpu has it, a slicing-by-8 table otherwise.
+ * \param crc The result of the previous chunk to checksum data in pieces.
+ */
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+/*!
+ * \brief Portable implementation, exposed to test the hardware one against it.
+ */
+uint32_t crc32cSoftware(const void* data, size_t size, uint32_t crc = 0);
+
+/*!
+ * \brief True if crc32c() uses the hardware instruction on this machine.
+ */
+bool crc32cHardwareSupported();
@@ -0,0 +1,254 @@
+#include <finder/DaemonProtocol.h>
+#include <finder/LocalSocket.h>
+#include <finder/StringPool.h>
+
+#include <cstdlib>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+static_assert(MAX_RESULTS_MESSAGE_SIZE < LocalSocket::MAX_MESSAGE_SIZE,
+              "a split message plus one path has to fit");
+
+namespace {
+std::string pathToUtf8(const std::filesystem::path& path) {
+  const std::u8string utf8 = path.u8string();
+  return std::string(utf8.begin(), utf8.end());
+}
+
+std::vector<std::string> readPaths(BinaryReader& reader) {
+  std::vector<std::string> paths(reader.readCount());
+  for (auto& path : paths) {
+    path = std::string(reader.readString());
+  }
+  return paths;
+}
+
+/*!
+ * \brief Puts the RESULTS messages of one update together. A message is sent before it
+ * would get larger than maxMessageSize, the paths of the ranking or of an insert continue
+ * as an insert in the next one. Only the last message is marked finished.
+ */
+class ResultsWriter {
+ public:
+  ResultsWriter(const Dictionary& dictionary,
+                const bool finished,
+                const size_t maxMessageSize,
+                const SendMessage& send)
+      : dictionary(dictionary), finished(finished), maxMessageSize(maxMessageSize), send(send) {}
+
+  bool writeRanking(const std::vector<EntryId>& ranking) {
+    isReset   = true;
+    isRanking = true;
+    return writeInsert(0, ranking);
+  }
+
+  bool writeChange(const ResultChange& change) {
+    if (change.type == ResultChange::Type::INSERT) {
+      return writeInsert(change.position, change.ids);
+    }
+    if (getMessageSize() > maxMessageSize && !flush(false)) {
+      return false;
+    }
+    changes.writePod(static_cast<uint8_t>(change.type));
+    changes.writeVarint(change.position);
+    changes.writeVarint(change.type == ResultChange::Type::REMOVE ? change.count : change.target);
+    ++numChanges;
+    return true;
+  }
+
+  bool finish() { return flush(true); }
+
+ private:
+  // type, flags, counts and the header of an insert
+  static constexpr size_t MAX_OVERHEAD = 64;
+
+  size_t getMessageSize() const { return MAX_OVERHEAD + changes.size() + paths.size(); }
+
+  bool writeInsert(const size_t position, const std::vector<EntryId>& ids) {
+    startPaths(position);
+    for (const EntryId id : ids) {
+      const std::string path = pathToUtf8(dictionary.getPath(id));
+      if (getMessageSize() + path.size() > maxMessageSize && (numPaths > 0 || numChanges > 0)) {
+        const size_t next = pathsPosition + numPaths;
+        if (!flush(false)) {
+          return false;
+        }
+        startPaths(next);
+      }
+      paths.writeString(path);
+      ++numPaths;
+    }
+    endPaths();
+    return true;
+  }
+
+  void startPaths(const size_t position) {
+    pathsPosition = position;
+    numPaths      = 0;
+  }
+
+  // the paths become an insert, unless they are the ranking of a reset
+  void endPaths() {
+    if (isRanking || numPaths == 0) {
+      return;
+    }
+    changes.writePod(static_cast<uint8_t>(ResultChange::Type::INSERT));
+    changes.writeVarint(pathsPosition);
+    changes.writeVarint(numPaths);
+    changes.writeBytes(paths.getBuffer().data(), paths.size());
+    ++numChanges;
+    paths    = BinaryWriter();
+    numPaths = 0;
+  }
+
+  bool flush(const bool last) {
+    endPaths();
+    BinaryWriter message;
+    message.writePod(static_cast<uint8_t>(DaemonMessage::RESULTS));
+    message.writePod(static_cast<uint8_t>(finished && last));
+    message.writePod(static_cast<uint8_t>(isReset));
+    if (isReset) {
+      message.writeVarint(numPaths);
+      message.writeBytes(paths.getBuffer().data(), paths.size());
+    } else {
+      message.writeVarint(numChanges);
+      message.writeBytes(changes.getBuffer().data(), changes.size());
+    }
+    // the rest is sent as changes against what this message holds
+    isReset    = false;
+    isRanking  = false;
+    changes    = BinaryWriter();
+    numChanges = 0;
+    paths      = BinaryWriter();
+    numPaths   = 0;
+    return send(message);
+  }
+
+  const Dictionary& dictionary;
+  const bool finished;
+  const size_t maxMessageSize;
+  const SendMessage& send;
+
+  bool isReset   = false;
+  bool isRanking = false;
+  BinaryWriter changes;
+  size_t numChanges = 0;
+  // the paths of the ranking or of the current insert
+  BinaryWriter paths;
+  size_t numPaths      = 0;
+  size_t pathsPosition = 0;
+};
+}  // namespace
+
+std::filesystem::path getDefaultDaemonSocket() {
+  const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+  if (runtimeDir != nullptr && *runtimeDir != '\0') {
+    return std::filesystem::path(runtimeDir) / "fscoutd.sock";
+  }
+#ifdef _WIN32
+  return std::filesystem::temp_directory_path() / "fscoutd.sock";
+#else
+  return std::filesystem::temp_directory_path() /
+         ("fscoutd-" + std::to_string(::getuid()) + ".sock");
+#endif
+}
+
+DaemonMessage readDaemonMessageType(BinaryReader& reader) {
+  const auto type = reader.readPod<uint8_t>();
+  if (type < static_cast<uint8_t>(DaemonMessage::SEARCH) ||
+      type > static_cast<uint8_t>(DaemonMessage::ERROR)) {
+    throw std::runtime_error("Unknown daemon message " + std::to_string(type));
+  }
+  return static_cast<DaemonMessage>(type);
+}
+
+void writeSearchRequest(BinaryWriter& writer,
+                        const std::filesystem::path& root,
+                        const std::wstring& needle) {
+  writer.writePod(static_cast<uint8_t>(DaemonMessage::SEARCH));
+  writer.writeVarint(DAEMON_PROTOCOL_VERSION);
+  writer.writeString(pathToUtf8(root));
+  writer.writeString(StringPool::toUtf8(needle));
+}
+
+void readSearchRequest(BinaryReader& reader, std::filesystem::path& root, std::wstring& needle) {
+  if (reader.readVarint() != DAEMON_PROTOCOL_VERSION) {
+    throw std::runtime_error("Unsupported protocol version");
+  }
+  const std::string_view utf8Root = reader.readString();
+  root   = std::filesystem::path(std::u8string(utf8Root.begin(), utf8Root.end()));
+  needle = StringPool::fromUtf8(reader.readString());
+}
+
+bool writeResults(const SearchResult& results,
+                  const bool reset,
+                  const SendMessage& send,
+                  const size_t maxMessageSize) {
+  if (!results.dictionary) {
+    BinaryWriter message;
+    message.writePod(static_cast<uint8_t>(DaemonMessage::RESULTS));
+    message.writePod(static_cast<uint8_t>(results.finished));
+    message.writePod(static_cast<uint8_t>(true));
+    message.writeVarint(0);
+    return send(message);
+  }
+  ResultsWriter writer(*results.dictionary, results.finished, maxMessageSize, send);
+  if (reset) {
+    if (!writer.writeRanking(results.update.ranking)) {
+      return false;
+    }
+  } else {
+    for (const ResultChange& change : results.update.changes) {
+      if (!writer.writeChange(change)) {
+        return false;
+      }
+    }
+  }
+  return writer.finish();
+}
+
+bool readResults(BinaryReader& reader, std::vector<std::string>& shownPaths) {
+  const bool finished = reader.readPod<uint8_t>() != 0;
+  const bool reset    = reader.readPod<uint8_t>() != 0;
+  if (reset) {
+    shownPaths = readPaths(reader);
+    return finished;
+  }
+
+  const size_t numChanges = reader.readCount();
+  for (size_t i = 0; i < numChanges; ++i) {
+    ResultChange change;
+    change.type     = static_cast<ResultChange::Type>(reader.readPod<uint8_t>());
+    change.position = reader.readVarint();
+    // the paths of an INSERT take the place of its ids
+    std::vector<std::string> paths;
+    switch (change.type) {
+      case ResultChange::Type::INSERT:
+        paths = readPaths(reader);
+        break;
+      case ResultChange::Type::REMOVE:
+        change.count = reader.readVarint();
+        break;
+      case ResultChange::Type::MOVE:
+        change.target = reader.readVarint();
+        break;
+      default:
+        throw std::runtime_error("Unknown result change");
+    }
+    if (!fitsResults(change, shownPaths.size())) {
+      throw std::runtime_error("Results do not fit the shown ones");
+    }
+    applyResultChange(change, shownPaths, std::move(paths));
+  }
+  return finished;
+}
+
+void writeError(BinaryWriter& writer, std::string_view message) {
+  writer.writePod(static_cast<uint8_t>(DaemonMessage::ERROR));
+  writer.writeString(message);
+}
+
+std::string readError(BinaryReader& reader) { return std::string(reader.readString()); }
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <finder/BinaryIO.h>
+#include <finder/SearchResult.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*!
+ * \brief Messages between fscoutd and its clients, sent over a LocalSocket.
+ *
+ * Every message starts with its DaemonMessage type. A client sends SEARCH, the daemon
+ * answers with RESULTS until one of them is finished, or with an ERROR.
+ * Results are paths (utf8): either the complete ranking, or like a ResultUpdate the
+ * changes against the ranking sent before on the same connection, so the partial
+ * results of a refined search only cost what changed. Large results are split over
+ * several RESULTS messages, only the last one is finished.
+ */
+enum class DaemonMessage : uint8_t { SEARCH = 1, RESULTS = 2, ERROR = 3 };
+
+constexpr uint32_t DAEMON_PROTOCOL_VERSION = 1;
+
+// the size RESULTS messages are split at, well below LocalSocket::MAX_MESSAGE_SIZE
+constexpr size_t MAX_RESULTS_MESSAGE_SIZE = 16u << 20;
+
+// sends a complete message, false if the connection is gone
+using SendMessage = std::function<bool(const BinaryWriter& message)>;
+
+/*!
+ * \brief $XDG_RUNTIME_DIR/fscoutd.sock, or a per user file in the temp folder.
+ */
+std::filesystem::path getDefaultDaemonSocket();
+
+DaemonMessage readDaemonMessageType(BinaryReader& reader);
+
+void writeSearchRequest(BinaryWriter& writer,
+                        const std::filesystem::path& root,
+                        const std::wstring& needle);
+/*!
+ * \brief Read the content of a SEARCH message, after its type.
+ * Throws std::runtime_error if the message is malformed or from another protocol version.
+ */
+void readSearchRequest(BinaryReader& reader, std::filesystem::path& root, std::wstring& needle);
+
+/*!
+ * \brief Send the results as RESULTS messages, the paths are decoded from the dictionary.
+ * \param reset Send the complete ranking instead of the changes, required if the
+ * receiver does not show results->update.baseVersion.
+ * \param maxMessageSize Larger results are split, no message exceeds it by more than
+ * one path.
+ * \return false as soon as send() fails.
+ */
+bool writeResults(const SearchResult& results,
+                  const bool reset,
+                  const SendMessage& send,
+                  const size_t maxMessageSize = MAX_RESULTS_MESSAGE_SIZE);
+
+/*!
+ * \brief Apply the content of a RESULTS message, after its type, to the shown paths.
+ * Throws std::runtime_error if the message is malformed or does not fit the paths.
+ * \return True if these were the final results of the search.
+ */
+bool readResults(BinaryReader& reader, std::vector<std::string>& shownPaths);
+
+void writeError(BinaryWriter& writer, std::string_view message);
+std::string readError(BinaryReader& reader);
@@ -1,14 +1,21 @@
 #include <finder/Dictionary.h>
 #include <finder/Needle.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <globals/globals.hpp>
+#include <globals/instrumentation.hpp>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <numeric>
+#include <queue>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utils/filesystem/filesystem.hpp>
 
 Dictionary::Dictionary() { tree = std::make_unique<Tree>(); }
@@ -16,24 +23,80 @@ Dictionary::Dictionary() { tree = std::make_unique<Tree>(); }
 Dictionary::~Dictionary() = default;
 
 
-void Dictionary::addPath(const std::filesystem::path& path, const bool isDirectory) {
-  std::wstring name = util::getLastPathComponent(path);
+EntryId Dictionary::addPath(const std::filesystem::path& path, const bool isDirectory) {
+  INSTRUMENT_SCOPE(INSERT);
+  const EntryId id  = paths.add(path, isDirectory);
+  std::wstring name = paths.getName(id);
   // to save storage and computation time, we save everything lower case.
   // The scoring function at the end will score exact matches better than case insensitive matches.
   std::transform(name.begin(), name.end(), name.begin(), ::tolower);
-  tree->insertWord(name, path, isDirectory);
+  tree->insertWord(name, id);
+  if (!isDirectory) {
+    extensions.add(id, name);
+  }
   ++size;
+  return id;
 }
 
+void Dictionary::finalize(const bool useEntropyCoder) { paths.finalize(useEntropyCoder); }
+
 
-void Dictionary::search(std::atomic<bool>& stopSearch,
-                        const std::wstring& needle_in,
-                        const size_t num_fuzzy_replacements,
-                        const wchar_t wildcard,
-                        std::vector<TreeNode::PathInfo>& matches) const {
+SearchProgress Dictionary::search(std::atomic<bool>& stopSearch,
+                                  const std::wstring& needle_in,
+                                  const size_t num_fuzzy_replacements,
+                                  const wchar_t wildcard,
+                                  std::vector<EntryId>& matches,
+                                  const SearchBudget& budget) const {
+  INSTRUMENT_SCOPE(SEARCH);
 
   // to save storage and computation time, we save everything lower case.
   // The scoring function at the end will score exact matches better than case insensitive matches.
+  std::wstring needle = needle_in;
+  std::transform(needle.begin(), needle.end(), needle.begin(), ::tolower);
+  auto makeNeedle = [&needle, wildcard](const size_t fuzzyReplacements) {
+    Needle n{needle};
+    if (fuzzyReplacements > 0) {
+      n.setFuzzySearch(fuzzyReplacements);
+    }
+    if (wildcard != NO_WILDCARD) {
+      n.useWildCard(wildcard);
+    }
+    return n;
+  };
+  if (!budget.isLimited()) {
+    return tree->search(makeNeedle(num_fuzzy_replacements), stopSearch, budget, matches);
+  }
+
+  // Every replacement costs score, and the fuzzy search visits by far the most nodes.
+  // So search with 0, 1, ... replacements, each pass gets what the previous ones left
+  // of the budget. A pass finds the matches of the previous ones again.
+  SearchProgress progress;
+  for (size_t replacements = 0; replacements <= num_fuzzy_replacements; ++replacements) {
+    SearchBudget remaining = budget;
+    remaining.maxNodesVisited -= std::min(progress.nodesVisited, budget.maxNodesVisited);
+    const SearchProgress pass =
+      tree->search(makeNeedle(replacements), stopSearch, remaining, matches);
+    progress.nodesVisited += pass.nodesVisited;
+    progress.complete = pass.complete;
+    if (!progress.complete || stopSearch.load()) {
+      break;
+    }
+  }
+  return progress;
+}
+
+
+SearchProgress Dictionary::searchBest(std::atomic<bool>& stopSearch,
+                                     const std::wstring& needle_in,
+                                     const size_t num_fuzzy_replacements,
+                                     const wchar_t wildcard,
+                                     const size_t maxResults,
+                                     const AcceptMatch& accept,
+                                     std::vector<EntryId>& matches,
+                                     const SearchBudget& budget,
+                                     const int maxBonus) const {
+  INSTRUMENT_SCOPE(SEARCH);
+
   std::wstring needle = needle_in;
   std::transform(needle.begin(), needle.end(), needle.begin(), ::tolower);
   Needle n{needle};
@@ -43,74 +106,568 @@ void Dictionary::search(std::atomic<bool>& stopSearch,
   if (wildcard != NO_WILDCARD) {
     n.useWildCard(wildcard);
   }
-  tree->search(n, stopSearch, matches);
+
+  // the lowest of the best maxResults scores so far on top
+  std::priority_queue<int, std::vector<int>, std::greater<int>> bestScores;
+  std::unordered_set<EntryId> scored;
+  size_t numScored = 0;
+  auto continueWithEdits = [&](const size_t edits) {
+    if (maxResults == 0) {
+      return true;
+    }
+    // Every edit needs at least one letter of the needle to mismatch in the best
+    // alignment of scoreMatch(), or to fall outside of the name. The scores kept below
+    // are without the bonus, the bound has to cover an unexplored match getting it all.
+    const int bound = static_cast<int>(needle_in.size()) * MAX_CHAR_SCORE -
+                      static_cast<int>(edits) * (MAX_CHAR_SCORE - MAX_MISMATCH_SCORE) +
+                      maxBonus;
+    auto isCertain = [&]() { return bestScores.size() == maxResults && bestScores.top() >= bound; };
+    // decoding the names is the expensive part, stop as soon as the best are certain
+    for (; numScored < matches.size() && !isCertain(); ++numScored) {
+      const EntryId id = matches[numScored];
+      if (!scored.insert(id).second) {
+        continue;
+      }
+      const std::wstring name = getName(id);
+      if (!accept(id, name)) {
+        continue;
+      }
+      bestScores.push(scoreMatch(needle_in, name));
+      if (bestScores.size() > maxResults) {
+        bestScores.pop();
+      }
+    }
+    return !isCertain();
+  };
+  return tree->searchBestFirst(n, stopSearch, budget, matches, continueWithEdits);
 }
 
 
-void Dictionary::serialize(const std::filesystem::path& filename,
-                           const std::chrono::steady_clock::time_point& timeOfIndexing) const {
-  std::wofstream outFile(filename, std::ios::binary);
+namespace {
+// the budget left after the nodes already visited
+SearchBudget getRemainingBudget(const SearchBudget& budget, const SearchProgress& progress) {
+  SearchBudget remaining = budget;
+  remaining.maxNodesVisited -= std::min(progress.nodesVisited, budget.maxNodesVisited);
+  return remaining;
+}
 
-  if (!outFile.is_open()) {
-    throw std::runtime_error("Could not open file for serialization");
+void addProgress(SearchProgress& progress, const SearchProgress& step) {
+  progress.nodesVisited += step.nodesVisited;
+  progress.complete = progress.complete && step.complete;
+}
+
+/*!
+ * \brief Whether the name contains the lower case needle with at most maxEdits
+ * replacements, insertions or deletions. For the names of a few folders, searching
+ * the tree for them would cost more.
+ */
+bool containsNeedle(const std::wstring& needle,
+                    std::wstring name,
+                    const size_t maxEdits,
+                    const wchar_t wildcard) {
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+  // row i: the fewest edits of the first i letters of the needle, ending at each
+  // letter of the name, starting anywhere
+  std::vector<size_t> previous(name.size() + 1, 0);
+  std::vector<size_t> current(name.size() + 1);
+  for (size_t i = 1; i <= needle.size(); ++i) {
+    current[0] = i;
+    for (size_t j = 1; j <= name.size(); ++j) {
+      const bool same = needle[i - 1] == name[j - 1] || needle[i - 1] == wildcard;
+      current[j] = std::min({previous[j - 1] + (same ? 0 : 1), previous[j] + 1, current[j - 1] + 1});
+    }
+    std::swap(previous, current);
   }
+  return *std::min_element(previous.begin(), previous.end()) <= maxEdits;
+}
 
-  // Write the global header: identifier, version, and indexing time
-  const std::wstring identifier = Globals::getInstance().getBinaryTreeFromatIdentifier();
-  constexpr uint32_t version = Globals::VERSION;
-  outFile.write(identifier.c_str(), identifier.size());
-  outFile.write(reinterpret_cast<const wchar_t*>(&version), sizeof(version));
+// Up to this many entries which could match a query, the terms not searched yet are
+// checked on each of them instead of searching the tree.
+constexpr size_t MAX_VERIFIED_CANDIDATES = 1 << 14;
+
+/*!
+ * \brief A guess how few names the term matches: its letters, less the ones which may
+ * be replaced or are a wildcard. Only a guess, a long needle may still be common.
+ */
+int getSelectivity(const Query::Term& term, const wchar_t wildcard) {
+  int letters = 0;
+  for (const Query::Segment& segment : term) {
+    const auto wildcards = std::count(segment.needle.begin(), segment.needle.end(), wildcard);
+    letters += static_cast<int>(segment.needle.size() - wildcards - segment.numFuzzyReplacements);
+  }
+  return letters;
+}
+}  // namespace
+
+SearchProgress Dictionary::searchTerm(std::atomic<bool>& stopSearch,
+                                      const Query::Term& term,
+                                      const wchar_t wildcard,
+                                      std::vector<EntryId>& termMatches,
+                                      const SearchBudget& budget) const {
+  // Only the innermost named segment is searched in the tree. The folders above its
+  // matches are few and shared, their names are checked directly.
+  const size_t last         = term.size() - 1;
+  const bool listsContent   = term[last].needle.empty();
+  const size_t searched     = listsContent ? last - 1 : last;
+  const wchar_t lowWildcard = static_cast<wchar_t>(::tolower(wildcard));
+  // The fuzzy search does not find every exact match, so the exact one runs first. A
+  // limited search makes the exact pass by itself.
+  std::vector<EntryId> candidates;
+  const Query::Segment& segment = term[searched];
+  SearchProgress progress;
+  if (segment.numFuzzyReplacements > 0 && !budget.isLimited()) {
+    progress = search(stopSearch, segment.needle, 0, wildcard, candidates, budget);
+  }
+  if (progress.complete && !stopSearch.load()) {
+    addProgress(progress,
+                search(stopSearch,
+                       segment.needle,
+                       segment.numFuzzyReplacements,
+                       wildcard,
+                       candidates,
+                       getRemainingBudget(budget, progress)));
+  }
 
-  // Serialize the timeOfIndexing (as seconds since epoch)
-  auto timeSinceEpoch =
-      std::chrono::duration_cast<std::chrono::seconds>(timeOfIndexing.time_since_epoch())
-          .count();
-  outFile.write(reinterpret_cast<const wchar_t*>(&timeSinceEpoch), sizeof(timeSinceEpoch));
+  // per segment the folders checked already
+  std::vector<std::unordered_map<EntryId, bool>> folderMatches(searched);
+  auto matchesFolders = [&](EntryId id) {
+    for (size_t segment = searched; segment-- > 0;) {
+      id = paths.getParent(id);
+      if (id == NO_ENTRY || paths.isBase(id)) {
+        return false;
+      }
+      auto [known, isNew] = folderMatches[segment].try_emplace(id, false);
+      if (isNew) {
+        std::wstring needle = term[segment].needle;
+        std::transform(needle.begin(), needle.end(), needle.begin(), ::tolower);
+        known->second =
+          containsNeedle(needle, getName(id), term[segment].numFuzzyReplacements, lowWildcard);
+      }
+      if (!known->second) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+  if (!listsContent) {
+    for (const EntryId id : candidates) {
+      if (matchesFolders(id)) {
+        termMatches.push_back(id);
+      }
+    }
+    return progress;
+  }
+  // the content of the matching folders
+  for (const EntryId id : candidates) {
+    if (paths.isDirectory(id) && matchesFolders(id)) {
+      paths.forEachChild(id, [&termMatches](const EntryId child) { termMatches.push_back(child); });
+    }
+  }
+  return progress;
+}
 
-  tree->serialize(outFile);
+SearchProgress Dictionary::searchQuery(std::atomic<bool>& stopSearch,
+                                       const Query& query,
+                                       const wchar_t wildcard,
+                                       std::vector<EntryId>& matches,
+                                       const SearchBudget& budget) const {
+  // without terms the filters are the result, every file with one of the extensions
+  const bool isFiltered    = !query.extensions.empty();
+  const EntryBitmap filter = isFiltered ? extensions.getEntries(query.extensions) : EntryBitmap();
+  // a lookup in the columns per match
+  auto hasMetadata = [this, &query](const EntryId id) {
+    return !query.metadata.isActive() ||
+           query.metadata.accepts(metadata.get(id), paths.isDirectory(id));
+  };
+  if (query.terms.empty()) {
+    if (isFiltered) {
+      filter.forEach([&](const EntryId id) {
+        if (hasMetadata(id)) {
+          matches.push_back(id);
+        }
+      });
+    } else if (query.metadata.isActive()) {
+      // A scan of the columns, nothing narrows it down. Every entry counts like a node of
+      // the tree, reading the clock costs more than an entry so it is read now and then.
+      constexpr size_t DEADLINE_CHECK_INTERVAL = 256;
+      SearchProgress progress;
+      for (EntryId id = 0; id < paths.size() && !stopSearch.load(); ++id) {
+        if (++progress.nodesVisited > budget.maxNodesVisited ||
+            (progress.nodesVisited % DEADLINE_CHECK_INTERVAL == 0 &&
+             SearchBudget::Clock::now() > budget.deadline)) {
+          progress.complete = false;
+          break;
+        }
+        if (!paths.isBase(id) && hasMetadata(id)) {
+          matches.push_back(id);
+        }
+      }
+      return progress;
+    }
+    return SearchProgress();
+  }
 
-  outFile.close();
+  // The most selective term is searched first. Once its matches and the content of its
+  // matching folders are few, the remaining terms are checked on them instead of
+  // searching the tree for each, "linux/usb asm" searches for "usb" only. A few files
+  // of the extension filter are checked the same way without any search.
+  std::vector<size_t> order(query.terms.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&query, wildcard](size_t a, size_t b) {
+    return getSelectivity(query.terms[a], wildcard) > getSelectivity(query.terms[b], wildcard);
+  });
+  // The tree search of a fuzzy segment tries other letters only where the needle does not
+  // go on, the check of a name would find more. Those terms are always searched.
+  auto isVerifiable = [&query](const size_t i) {
+    const Query::Term& term = query.terms[i];
+    return term[term.size() - (term.back().needle.empty() ? 2 : 1)].numFuzzyReplacements == 0;
+  };
+
+  // the matches and everything below the matching folders, false if too many
+  std::vector<EntryId> candidates;
+  auto collectCandidates = [&](const std::vector<EntryId>& termMatches) {
+    candidates.clear();
+    std::vector<EntryId> folders;
+    for (const EntryId id : termMatches) {
+      candidates.push_back(id);
+      if (paths.isDirectory(id)) {
+        folders.push_back(id);
+      }
+    }
+    while (!folders.empty() && candidates.size() <= MAX_VERIFIED_CANDIDATES) {
+      const EntryId folder = folders.back();
+      folders.pop_back();
+      paths.forEachChild(folder, [&](const EntryId child) {
+        candidates.push_back(child);
+        if (paths.isDirectory(child)) {
+          folders.push_back(child);
+        }
+      });
+    }
+    if (candidates.size() > MAX_VERIFIED_CANDIDATES) {
+      return false;
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return true;
+  };
+  bool isVerifying = isFiltered && filter.count() <= MAX_VERIFIED_CANDIDATES;
+  if (isVerifying) {
+    filter.forEach([&candidates](const EntryId id) { candidates.push_back(id); });
+  }
+
+  // the sorted matches of every term searched in the tree
+  SearchProgress progress;
+  std::vector<std::vector<EntryId>> found(query.terms.size());
+  std::vector<bool> isSearched(query.terms.size(), false);
+  for (const size_t i : order) {
+    if (!progress.complete || stopSearch.load()) {
+      break;
+    }
+    if (isVerifying && isVerifiable(i)) {
+      continue;
+    }
+    addProgress(progress,
+                searchTerm(stopSearch,
+                           query.terms[i],
+                           wildcard,
+                           found[i],
+                           getRemainingBudget(budget, progress)));
+    isSearched[i] = true;
+    std::sort(found[i].begin(), found[i].end());
+    found[i].erase(std::unique(found[i].begin(), found[i].end()), found[i].end());
+    if (found[i].empty()) {
+      return progress;
+    }
+    if (!isVerifying) {
+      isVerifying = collectCandidates(found[i]);
+    }
+  }
+  if (stopSearch.load()) {
+    return progress;
+  }
+
+  if (isVerifying) {
+    verifyCandidates(query, wildcard, candidates, found, isSearched, [&](const EntryId id) {
+      if ((!isFiltered || filter.contains(id)) && hasMetadata(id)) {
+        matches.push_back(id);
+      }
+    });
+    return progress;
+  }
+
+  // Too many candidates for every term: join the matches of the terms. Per entry a bit
+  // for every term matching there.
+  std::unordered_map<EntryId, uint64_t> termBits;
+  for (size_t i = 0; i < query.terms.size(); ++i) {
+    for (const EntryId id : found[i]) {
+      termBits[id] |= uint64_t{1} << i;
+    }
+  }
+
+  // An entry needs every term on itself or on a folder above. The bits of the folders
+  // are collected once per folder, most entries share them.
+  const uint64_t allTerms = query.terms.size() >= 64 ? ~uint64_t{0}
+                                                     : (uint64_t{1} << query.terms.size()) - 1;
+  std::unordered_map<EntryId, uint64_t> folderBits;
+  std::vector<EntryId> unknownFolders;
+  auto getFolderBits = [&](const EntryId folder) {
+    // walk up to a folder which is known or the top
+    uint64_t bits = 0;
+    for (EntryId id = folder; id != NO_ENTRY && !paths.isBase(id); id = paths.getParent(id)) {
+      const auto known = folderBits.find(id);
+      if (known != folderBits.end()) {
+        bits = known->second;
+        break;
+      }
+      unknownFolders.push_back(id);
+    }
+    // and down again, each one gets the bits of the folders above
+    for (; !unknownFolders.empty(); unknownFolders.pop_back()) {
+      const auto own = termBits.find(unknownFolders.back());
+      bits |= own != termBits.end() ? own->second : 0;
+      folderBits.emplace(unknownFolders.back(), bits);
+    }
+    return bits;
+  };
+  if (!isFiltered) {
+    for (const auto& [id, bits] : termBits) {
+      if (stopSearch.load()) {
+        break;
+      }
+      if ((bits | getFolderBits(paths.getParent(id))) == allTerms && hasMetadata(id)) {
+        matches.push_back(id);
+      }
+    }
+    return progress;
+  }
+  // The extension matches on the name of the file, so its terms may all be on folders:
+  // "include ext:h" finds every header below a folder include.
+  filter.forEach([&](const EntryId id) {
+    if (stopSearch.load()) {
+      return;
+    }
+    const auto own = termBits.find(id);
+    if (((own != termBits.end() ? own->second : 0) | getFolderBits(paths.getParent(id))) ==
+          allTerms &&
+        hasMetadata(id)) {
+      matches.push_back(id);
+    }
+  });
+  return progress;
 }
 
-void Dictionary::deserialize(const std::filesystem::path& filename,
-                             std::chrono::steady_clock::time_point* timeOfIndexing) {
-  std::wifstream inFile(filename, std::ios::binary);
+void Dictionary::verifyCandidates(const Query& query,
+                                  const wchar_t wildcard,
+                                  const std::vector<EntryId>& candidates,
+                                  const std::vector<std::vector<EntryId>>& found,
+                                  const std::vector<bool>& isSearched,
+                                  const std::function<void(EntryId)>& onMatch) const {
+  const wchar_t lowWildcard = static_cast<wchar_t>(::tolower(wildcard));
+  std::vector<std::vector<std::wstring>> needles(query.terms.size());
+  for (size_t i = 0; i < query.terms.size(); ++i) {
+    for (const Query::Segment& segment : query.terms[i]) {
+      std::wstring& needle = needles[i].emplace_back(segment.needle);
+      std::transform(needle.begin(), needle.end(), needle.begin(), ::tolower);
+    }
+  }
+  // the names are decoded once, the folders are shared by many candidates
+  std::unordered_map<EntryId, std::wstring> names;
+  auto getCachedName = [&](const EntryId id) -> const std::wstring& {
+    auto [name, isNew] = names.try_emplace(id);
+    if (isNew) {
+      name->second = getName(id);
+    }
+    return name->second;
+  };
+  // whether term i matches the entry itself, as searchTerm() would have found it
+  auto matchesTerm = [&](const size_t i, const EntryId id) {
+    if (isSearched[i]) {
+      return std::binary_search(found[i].begin(), found[i].end(), id);
+    }
+    const Query::Term& term = query.terms[i];
+    EntryId entry           = id;
+    size_t segment          = term.size();
+    if (term.back().needle.empty()) {
+      entry = paths.getParent(id);
+      --segment;
+    }
+    while (segment-- > 0) {
+      if (entry == NO_ENTRY || paths.isBase(entry) ||
+          !containsNeedle(needles[i][segment],
+                          getCachedName(entry),
+                          term[segment].numFuzzyReplacements,
+                          lowWildcard)) {
+        return false;
+      }
+      entry = paths.getParent(entry);
+    }
+    return true;
+  };
+  // per term whether it matches a folder or one above it
+  std::vector<std::unordered_map<EntryId, bool>> folderMatches(query.terms.size());
+  std::vector<EntryId> unknownFolders;
+  auto matchesAbove = [&](const size_t i, const EntryId folder) {
+    // walk up to a folder which is known or the top
+    bool matches = false;
+    for (EntryId id = folder; id != NO_ENTRY && !paths.isBase(id); id = paths.getParent(id)) {
+      const auto known = folderMatches[i].find(id);
+      if (known != folderMatches[i].end()) {
+        matches = known->second;
+        break;
+      }
+      unknownFolders.push_back(id);
+    }
+    for (; !unknownFolders.empty(); unknownFolders.pop_back()) {
+      matches = matches || matchesTerm(i, unknownFolders.back());
+      folderMatches[i].emplace(unknownFolders.back(), matches);
+    }
+    return matches;
+  };
 
-  if (!inFile.is_open()) {
-    throw std::runtime_error("Could not open file for deserialization");
+  const bool isFiltered = !query.extensions.empty();
+  for (const EntryId id : candidates) {
+    // as in the join: every term on the entry or above, one on the entry unless filtered
+    bool hasOwnMatch = isFiltered;
+    bool matchesAll  = true;
+    for (size_t i = 0; i < query.terms.size() && matchesAll; ++i) {
+      const bool own = matchesTerm(i, id);
+      hasOwnMatch    = hasOwnMatch || own;
+      matchesAll     = own || matchesAbove(i, paths.getParent(id));
+    }
+    if (matchesAll && hasOwnMatch) {
+      onMatch(id);
+    }
   }
+}
 
-  // Read the global header: identifier, version, and indexing time
-  const std::wstring identifier = Globals::getInstance().getBinaryTreeFromatIdentifier();
-  wchar_t identifierBuffer[identifier.size()];
-  uint32_t version = 0;
 
-  inFile.read(identifierBuffer, identifier.size());
+void Dictionary::buildTree() {
+  // group the entries by name, so every name is decoded and inserted only once
+  const StringPool& names = paths.getNames();
+  std::vector<size_t> firstEntry(names.size() + 1, 0);
+  for (EntryId id = 0; id < paths.size(); ++id) {
+    if (!paths.isBase(id)) {
+      ++firstEntry[paths.getNameId(id) + 1];
+    }
+  }
+  std::partial_sum(firstEntry.begin(), firstEntry.end(), firstEntry.begin());
+  std::vector<EntryId> entriesByName(firstEntry.back());
+  std::vector<size_t> next(firstEntry.begin(), firstEntry.end() - 1);
+  for (EntryId id = 0; id < paths.size(); ++id) {
+    if (!paths.isBase(id)) {
+      entriesByName[next[paths.getNameId(id)]++] = id;
+    }
+  }
 
-  // Check if the identifier matches
-  if (std::wstring(identifierBuffer, identifier.size()) != identifier) {
-    throw std::runtime_error(
-        "File identifier does not match. This file may not be serialized by "
-        "this program.");
+  tree       = std::make_unique<Tree>();
+  extensions = ExtensionIndex();
+  size       = entriesByName.size();
+  // the extension of every name is taken apart once, the files are added in id order
+  std::vector<EntryBitmap*> extensionOfName(names.size(), nullptr);
+  names.forEach([this, &firstEntry, &entriesByName, &extensionOfName](
+                  const StringPool::StringId nameId, const std::wstring& name) {
+    if (firstEntry[nameId] == firstEntry[nameId + 1]) {
+      return;  // only used by base entries
+    }
+    std::wstring word = name;
+    std::transform(word.begin(), word.end(), word.begin(), ::tolower);
+    for (size_t i = firstEntry[nameId]; i < firstEntry[nameId + 1]; ++i) {
+      tree->insertWord(word, entriesByName[i]);
+    }
+    extensionOfName[nameId] = extensions.getBitmap(word);
+  });
+  for (EntryId id = 0; id < paths.size(); ++id) {
+    EntryBitmap* bitmap = paths.isBase(id) ? nullptr : extensionOfName[paths.getNameId(id)];
+    if (bitmap != nullptr && !paths.isDirectory(id)) {
+      bitmap->add(id);
+    }
   }
+}
 
-  inFile.read(reinterpret_cast<wchar_t*>(&version), sizeof(version));
+std::unique_ptr<Dictionary> Dictionary::clone() const {
+  auto copy        = std::make_unique<Dictionary>();
+  copy->tree       = tree->clone();
+  copy->paths      = paths;
+  copy->extensions = extensions;
+  copy->metadata   = metadata;
+  copy->size       = size;
+  return copy;
+}
 
-  // Handle different versions if needed (for now we assume version 1)
-  if (version != Globals::VERSION) {
-    throw std::runtime_error("Unsupported file version.");
+bool Dictionary::serialize(const std::filesystem::path& filename,
+                           const std::chrono::steady_clock::time_point& timeOfIndexing,
+                           const std::atomic<bool>* stop) const {
+  INSTRUMENT_SCOPE(SERIALIZE);
+  // Serialize the timeOfIndexing (as seconds since epoch)
+  // The steady clock has no meaning after a reboot, so store the system time.
+  const auto systemTimeOfIndexing =
+      std::chrono::system_clock::now() +
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          timeOfIndexing - std::chrono::steady_clock::now());
+  const int64_t timeSinceEpoch = std::chrono::duration_cast<std::chrono::seconds>(
+                                     systemTimeOfIndexing.time_since_epoch())
+                                     .count();
+
+  // the tree is not stored, it is rebuild from the names when loading
+  IndexFileWriter file;
+  BinaryWriter pathTable;
+  paths.serialize(pathTable);
+  file.addSection(IndexSection::PATH_TABLE, std::move(pathTable));
+  if (!metadata.empty()) {
+    BinaryWriter metadataColumns;
+    metadata.serialize(metadataColumns);
+    file.addSection(IndexSection::METADATA, std::move(metadataColumns));
+  }
+  if (stop != nullptr && stop->load()) {
+    return false;
   }
 
-  // Deserialize the timeOfIndexing (as seconds since epoch)
-  std::time_t timeSinceEpoch;
-  inFile.read(reinterpret_cast<wchar_t*>(&timeSinceEpoch), sizeof(timeSinceEpoch));
-  *timeOfIndexing =
-      std::chrono::steady_clock::time_point(std::chrono::seconds(timeSinceEpoch));
+  file.write(filename, timeSinceEpoch);
+  return true;
+}
 
-  tree = std::make_unique<Tree>();
-  tree->deserialize(inFile);
+void Dictionary::deserialize(const std::filesystem::path& filename,
+                             std::chrono::steady_clock::time_point* timeOfIndexing,
+                             const IndexValidation validation) {
+  INSTRUMENT_SCOPE(DESERIALIZE);
+  // checks identifier, version and the section table before reading anything else
+  IndexFileReader file(filename, validation);
+
+  // one sequential read, the names are decoded later on demand
+  const std::vector<char> pathTable = file.readSection(IndexSection::PATH_TABLE);
+  BinaryReader reader(pathTable.data(), pathTable.size());
+  PathTable newPaths;
+  newPaths.deserialize(reader);
+  if (!reader.atEnd()) {
+    throw std::runtime_error("Corrupted index: unexpected data after the path table");
+  }
 
-  inFile.close();
+  // older files and indexes crawled without metadata have no columns
+  MetadataColumns newMetadata;
+  if (file.hasSection(IndexSection::METADATA)) {
+    const std::vector<char> columns = file.readSection(IndexSection::METADATA);
+    BinaryReader columnReader(columns.data(), columns.size());
+    newMetadata.deserialize(columnReader, newPaths.size());
+    if (!columnReader.atEnd()) {
+      throw std::runtime_error("Corrupted index: unexpected data after the metadata");
+    }
+  }
+
+  paths    = std::move(newPaths);
+  metadata = std::move(newMetadata);
+  buildTree();
+
+  // Deserialize the timeOfIndexing (as seconds since epoch)
+  const auto systemTimeOfIndexing =
+      std::chrono::system_clock::time_point(std::chrono::seconds(file.getTimeOfIndexing()));
+  *timeOfIndexing =
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          systemTimeOfIndexing - std::chrono::system_clock::now());
 }
 
 int Dictionary::scoreChars(wchar_t a, wchar_t b) {
@@ -145,18 +702,19 @@ int Dictionary::scoreChars(wchar_t a, wchar_t b) {
   // clang-format on
 
   if (a == b)
-    return 3;  // Exact match
+    return MAX_CHAR_SCORE;  // Exact match
   if (std::tolower(a) == std::tolower(b))
     return 2;  // Case mismatch
 
   // Commonly confused characters
-  if ((confusedChars.count(a) &&
-       std::find(confusedChars.at(a).begin(), confusedChars.at(a).end(), b) !=
-           confusedChars.at(a).end()) ||
-      (confusedChars.count(b) &&
-       std::find(confusedChars.at(b).begin(), confusedChars.at(b).end(), a) !=
-           confusedChars.at(b).end())) {
-    return 1;
+  const auto isConfusedWith = [](const wchar_t x, const wchar_t y) {
+    const auto confused = confusedChars.find(x);
+    return confused != confusedChars.end() &&
+           std::find(confused->second.begin(), confused->second.end(), y) !=
+             confused->second.end();
+  };
+  if (isConfusedWith(a, b) || isConfusedWith(b, a)) {
+    return MAX_MISMATCH_SCORE;
   }
 
   return 0;  // Total mismatch
@@ -180,39 +738,65 @@ int Dictionary::scoreMatch(const std::wstring& searchString, const std::wstring&
   return bestScore;
 }
 
+int Dictionary::scoreQuery(const Query& query, const std::wstring& match) {
+  int score = 0;
+  for (const Query::Term& term : query.terms) {
+    score += scoreMatch(term.back().needle, match);
+  }
+  return score;
+}
+
 std::vector<int> Dictionary::getMatchScores(const std::wstring& searchString,
                                             const std::wstring& match) {
   std::vector<int> charScores(match.size());
-  std::vector<int> bestScores;
-  int bestScoreOffset = -(int)searchString.size() + 1;
-  int bestScore = 0;
+  getMatchScores(searchString, match, charScores.data());
+  return charScores;
+}
 
-  for (int offset = -(int)searchString.size() + 1; offset < (int)match.size(); ++offset) {
-    std::vector<int> tempScores;
+void Dictionary::getMatchScores(std::wstring_view searchString,
+                                std::wstring_view match,
+                                int* scores) {
+  const int needleSize = static_cast<int>(searchString.size());
+  const int matchSize  = static_cast<int>(match.size());
+
+  // find the best alignment first, then score only that one per character
+  int bestScoreOffset = -needleSize + 1;
+  int bestScore       = 0;
+  for (int offset = -needleSize + 1; offset < matchSize; ++offset) {
     int score = 0;
-    for (int i = 0; i < (int)searchString.size(); ++i) {
-      int matchIdx = i + offset;
-      if (matchIdx >= 0 && matchIdx < (int)match.size()) {
-        tempScores.push_back(scoreChars(searchString[i], match[matchIdx]));
-        score += tempScores.back();
-      }
+    for (int i = std::max(0, -offset); i < needleSize && i + offset < matchSize; ++i) {
+      score += scoreChars(searchString[i], match[i + offset]);
     }
-
     if (bestScore < score) {
-      bestScore = score;
+      bestScore       = score;
       bestScoreOffset = offset;
-      bestScores = tempScores;
     }
   }
-  for (int i = 0; i < (int)charScores.size(); ++i) {
-    int matchIdx = i - bestScoreOffset;
-    if (matchIdx < 0 || matchIdx > (int)bestScores.size()) {
-      charScores[i] = 0;
+
+  for (int i = 0; i < matchSize; ++i) {
+    const int needleIdx = i - bestScoreOffset;
+    if (bestScore == 0 || needleIdx < 0 || needleIdx >= needleSize) {
+      scores[i] = 0;
     } else {
-      charScores[i] = bestScores[matchIdx];
+      scores[i] = scoreChars(searchString[needleIdx], match[i]);
     }
   }
-  return charScores;
+}
+
+IndexStatistics Dictionary::getStatistics() const {
+  IndexStatistics statistics;
+  statistics.numEntries           = size;
+  statistics.numPathEntries       = paths.size();
+  statistics.numNames             = paths.getNames().size();
+  statistics.numExtensions        = extensions.size();
+  statistics.bytes.names          = paths.getNames().getMemoryUsage();
+  statistics.bytes.pathTable      = paths.getMemoryUsage();
+  statistics.bytes.extensionIndex = extensions.getMemoryUsage();
+  statistics.bytes.metadata       = metadata.getMemoryUsage();
+  if (tree) {
+    tree->collectStatistics(statistics);
+  }
+  return statistics;
 }
 
 void Dictionary::visualize() const {
@@ -1,11 +1,20 @@
 #pragma once
 
+#include <finder/ExtensionIndex.h>
+#include <finder/IndexFile.h>
+#include <finder/IndexStatistics.h>
+#include <finder/MetadataColumns.h>
+#include <finder/PathTable.h>
+#include <finder/Query.h>
+#include <finder/SearchBudget.h>
 #include <finder/SearchPattern.h>
 #include <finder/Tree.h>
 
 #include <filesystem>
+#include <functional>
 #include <map>
 #include <string>
+#include <string_view>
 
 class Dictionary {
  public:
@@ -13,31 +22,174 @@ class Dictionary {
   Dictionary();
   ~Dictionary();
 
-  void addPath(const std::filesystem::path &, const bool);
+  EntryId addPath(const std::filesystem::path &, const bool);
 
+  /*!
+   * \brief Store the size and modification time of an added entry.
+   */
+  void setMetadata(const EntryId id, const EntryMetadata &entryMetadata) {
+    metadata.set(id, entryMetadata);
+  }
 
-  void search(std::atomic<bool> &stopSearch,
-              const std::wstring &needle_in,
-              const size_t num_fuzzy_replacements,
-              const wchar_t wildcard,
-              std::vector<TreeNode::PathInfo> &matches) const;
+  /*!
+   * \brief Compress the stored names once all paths are added.
+   * \param useEntropyCoder Huffman code the names on top of the front coding.
+   */
+  void finalize(const bool useEntropyCoder);
 
-  void serialize(const std::filesystem::path &filename,
-                 const std::chrono::steady_clock::time_point &timeOfIndexing) const;
+  /*!
+   * \brief Append the entries whose name contains the needle to matches, an entry
+   * may be appended more than once.
+   * With a limited budget, matches with fewer fuzzy replacements are searched first,
+   * so a search running out of budget keeps the best ones.
+   * \return The number of tree nodes visited and whether the search finished in budget.
+   */
+  SearchProgress search(std::atomic<bool> &stopSearch,
+                        const std::wstring &needle_in,
+                        const size_t num_fuzzy_replacements,
+                        const wchar_t wildcard,
+                        std::vector<EntryId> &matches,
+                        const SearchBudget &budget = SearchBudget()) const;
+
+  // whether a match with the given name counts
+  using AcceptMatch = std::function<bool(EntryId, const std::wstring &)>;
+
+  /*!
+   * \brief Find the maxResults matches with the best scoreMatch() first, best-first
+   * through the tree. Stops as soon as nothing unexplored can score better than them.
+   * Unlike search(), every name within the fuzzy replacements is found.
+   * \param accept Filters the matches counted into maxResults, like the caller does. It
+   * gets the name as well, decoding it is the expensive part.
+   * \param matches Receives all matches found until then, in no particular order.
+   * \param maxBonus The most the caller adds to a score when ranking, e.g. for having
+   * been opened before. An unexplored match could be lifted by it, so it widens the bound.
+   */
+  SearchProgress searchBest(std::atomic<bool> &stopSearch,
+                            const std::wstring &needle,
+                            const size_t num_fuzzy_replacements,
+                            const wchar_t wildcard,
+                            const size_t maxResults,
+                            const AcceptMatch &accept,
+                            std::vector<EntryId> &matches,
+                            const SearchBudget &budget = SearchBudget(),
+                            const int maxBonus         = 0) const;
+
+  /*!
+   * \brief Search a query of several terms or path segments, see Query. The most
+   * selective term is searched in the tree first. If its matches and the content of its
+   * matching folders are few, the other terms are checked on them, otherwise every term
+   * is searched and they are joined on the entry ids and the folders above them. No path
+   * is assembled. The extension filters of the query are looked up
+   * in the ExtensionIndex, without terms they are all there is to search. The metadata
+   * filter is checked on every match, entries without metadata do not pass it.
+   * \param matches Receives every match once.
+   */
+  SearchProgress searchQuery(std::atomic<bool> &stopSearch,
+                             const Query &query,
+                             const wchar_t wildcard,
+                             std::vector<EntryId> &matches,
+                             const SearchBudget &budget = SearchBudget()) const;
+
+  /*!
+   * \brief Deep copy, used to snapshot an index which is still being build.
+   */
+  std::unique_ptr<Dictionary> clone() const;
+
+  /*!
+   * \brief Write the index into the given file.
+   * \param stop If given and set while writing, serialization is aborted.
+   * \return false if aborted, the file content is undefined then.
+   */
+  bool serialize(const std::filesystem::path &filename,
+                 const std::chrono::steady_clock::time_point &timeOfIndexing,
+                 const std::atomic<bool> *stop = nullptr) const;
+  /*!
+   * \brief Load the index from the given file.
+   * Throws std::runtime_error if the file is not a valid index, this dictionary
+   * must not be used then.
+   * \param validation HEADER_ONLY skips the section checksums. The content is
+   * still bounds checked while parsing, so a corrupted file can not crash us.
+   */
   void deserialize(const std::filesystem::path &filename,
-                   std::chrono::steady_clock::time_point *timeOfIndexing);
+                   std::chrono::steady_clock::time_point *timeOfIndexing,
+                   const IndexValidation validation = IndexValidation::FULL);
 
 
   void visualize() const;
 
+  /*!
+   * \brief Count the nodes and bytes of the index. Walks the whole tree, so it takes
+   * a while on large indexes.
+   */
+  IndexStatistics getStatistics() const;
+
   size_t getSize() const { return size; }
 
+  /*!
+   * \brief The files by extension, for filters and for counting the extensions of results.
+   */
+  const ExtensionIndex &getExtensions() const { return extensions; }
+
+  // Results are entry ids, these decode the stored names on demand.
+  std::filesystem::path getPath(const EntryId id) const { return paths.getPath(id); }
+  std::wstring getName(const EntryId id) const { return paths.getName(id); }
+  bool isDirectory(const EntryId id) const { return paths.isDirectory(id); }
+  EntryMetadata getMetadata(const EntryId id) const { return metadata.get(id); }
+  // false for an index crawled without metadata
+  bool hasMetadata() const { return !metadata.empty(); }
+
+  // scoreChars() of equal letters, and the most it gives two different ones
+  static constexpr int MAX_CHAR_SCORE     = 3;
+  static constexpr int MAX_MISMATCH_SCORE = 1;
   static int scoreChars(wchar_t a, wchar_t b);
   static int scoreMatch(const std::wstring &needle, const std::wstring &match);
+  /*!
+   * \brief The scoreMatch() of the last segment of every term. Terms matching a folder
+   * instead of the name add little.
+   */
+  static int scoreQuery(const Query &query, const std::wstring &match);
   static std::vector<int> getMatchScores(const std::wstring &needle,
                                          const std::wstring &match);
+  /*!
+   * \brief Score every character of match as scoreChars() does, aligned where the
+   * needle matches best. Characters outside the needle score 0. Does not allocate.
+   * \param scores Receives match.size() scores.
+   */
+  static void getMatchScores(std::wstring_view needle, std::wstring_view match, int *scores);
 
  private:
+  /*!
+   * \brief Rebuild the search tree and the extension index from the path table. Storing
+   * the names is much smaller than storing the tree, and inserting them is about as fast
+   * as reading it.
+   */
+  void buildTree();
+
+  /*!
+   * \brief The entries matching the term: the last segment matches their name, the
+   * segments before the names of the folders above.
+   */
+  SearchProgress searchTerm(std::atomic<bool> &stopSearch,
+                            const Query::Term &term,
+                            const wchar_t wildcard,
+                            std::vector<EntryId> &termMatches,
+                            const SearchBudget &budget) const;
+
+  /*!
+   * \brief Call onMatch for every candidate matching the query, without the filters.
+   * The terms searched already are looked up in found, the others are checked on the
+   * names of the candidates and their folders.
+   */
+  void verifyCandidates(const Query &query,
+                        const wchar_t wildcard,
+                        const std::vector<EntryId> &candidates,
+                        const std::vector<std::vector<EntryId>> &found,
+                        const std::vector<bool> &isSearched,
+                        const std::function<void(EntryId)> &onMatch) const;
+
   std::unique_ptr<Tree> tree;
+  PathTable paths;
+  ExtensionIndex extensions;
+  MetadataColumns metadata;
   size_t size = 0;
 };
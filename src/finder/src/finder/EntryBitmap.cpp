@@ -0,0 +1,70 @@
+#include <finder/EntryBitmap.h>
+
+#include <algorithm>
+
+void EntryBitmap::add(const EntryId id) {
+  const uint32_t position = static_cast<uint32_t>(id / WORD_BITS);
+  const uint64_t bit      = uint64_t{1} << (id % WORD_BITS);
+  if (positions.empty() || positions.back() < position) {
+    positions.push_back(position);
+    words.push_back(bit);
+    return;
+  }
+  const auto it      = std::lower_bound(positions.begin(), positions.end(), position);
+  const size_t index = static_cast<size_t>(it - positions.begin());
+  if (*it == position) {
+    words[index] |= bit;
+  } else {
+    positions.insert(it, position);
+    words.insert(words.begin() + index, bit);
+  }
+}
+
+bool EntryBitmap::contains(const EntryId id) const {
+  const uint32_t position = static_cast<uint32_t>(id / WORD_BITS);
+  const auto it           = std::lower_bound(positions.begin(), positions.end(), position);
+  return it != positions.end() && *it == position &&
+         (words[it - positions.begin()] >> (id % WORD_BITS) & 1) != 0;
+}
+
+size_t EntryBitmap::count() const {
+  size_t count = 0;
+  for (const uint64_t word : words) {
+    count += std::popcount(word);
+  }
+  return count;
+}
+
+size_t EntryBitmap::countIntersection(const EntryBitmap& other) const {
+  if (other.words.size() < words.size()) {
+    return other.countIntersection(*this);
+  }
+  // both are sorted, each lookup continues where the last one ended
+  size_t count = 0;
+  auto start   = other.positions.begin();
+  for (size_t i = 0; i < words.size() && start != other.positions.end(); ++i) {
+    start = std::lower_bound(start, other.positions.end(), positions[i]);
+    if (start != other.positions.end() && *start == positions[i]) {
+      count += std::popcount(words[i] & other.words[start - other.positions.begin()]);
+    }
+  }
+  return count;
+}
+
+EntryBitmap& EntryBitmap::operator|=(const EntryBitmap& other) {
+  EntryBitmap merged;
+  merged.positions.reserve(std::max(positions.size(), other.positions.size()));
+  merged.words.reserve(merged.positions.capacity());
+  size_t i = 0;
+  size_t j = 0;
+  while (i < positions.size() || j < other.positions.size()) {
+    const bool takeOwn   = j == other.positions.size() ||
+                         (i < positions.size() && positions[i] <= other.positions[j]);
+    const bool takeOther = i == positions.size() ||
+                           (j < other.positions.size() && other.positions[j] <= positions[i]);
+    merged.positions.push_back(takeOwn ? positions[i] : other.positions[j]);
+    merged.words.push_back((takeOwn ? words[i++] : 0) | (takeOther ? other.words[j++] : 0));
+  }
+  *this = std::move(merged);
+  return *this;
+}
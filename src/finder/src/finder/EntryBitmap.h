@@ -0,0 +1,58 @@
+#pragma once
+
+#include <finder/EntryId.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief A set of entry ids as a compressed bitmap: only the 64 bit words which hold at
+ * least one id are stored, each with its position. Entries added together (e.g. the
+ * files of a folder) get neighbouring ids, so most words hold several of them.
+ *
+ * Intersections walk the smaller bitmap and look up its words in the larger one, they
+ * cost about as much as the smaller bitmap has words.
+ */
+class EntryBitmap {
+ public:
+  static constexpr size_t WORD_BITS = 64;
+
+  /*!
+   * \brief Add an id, fastest in increasing order of the ids.
+   */
+  void add(const EntryId id);
+
+  bool contains(const EntryId id) const;
+  bool empty() const { return words.empty(); }
+  // number of ids
+  size_t count() const;
+
+  /*!
+   * \brief Number of ids in both bitmaps, without building their intersection.
+   */
+  size_t countIntersection(const EntryBitmap& other) const;
+  EntryBitmap& operator|=(const EntryBitmap& other);
+
+  /*!
+   * \brief Call f(EntryId) for every id in increasing order.
+   */
+  template <typename F>
+  void forEach(F&& f) const {
+    for (size_t i = 0; i < words.size(); ++i) {
+      for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+        f(static_cast<EntryId>(positions[i] * WORD_BITS + std::countr_zero(word)));
+      }
+    }
+  }
+
+  size_t getMemoryUsage() const {
+    return positions.capacity() * sizeof(uint32_t) + words.capacity() * sizeof(uint64_t);
+  }
+
+ private:
+  // sorted, the word i holds the ids positions[i] * 64 + bit
+  std::vector<uint32_t> positions;
+  std::vector<uint64_t> words;
+};
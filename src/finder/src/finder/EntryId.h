@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+// Every indexed file or folder is identified by its position in the PathTable.
+using EntryId = uint32_t;
+
+constexpr EntryId NO_ENTRY = std::numeric_limits<EntryId>::max();
@@ -0,0 +1,71 @@
+#include <finder/ExtensionIndex.h>
+
+#include <algorithm>
+
+std::wstring ExtensionIndex::getExtension(const std::wstring& lowerCaseName) {
+  const size_t dot = lowerCaseName.rfind(L'.');
+  if (dot == std::wstring::npos || dot == 0 || dot + 1 == lowerCaseName.size() ||
+      lowerCaseName.size() - dot - 1 > MAX_EXTENSION_LENGTH) {
+    return std::wstring();
+  }
+  return lowerCaseName.substr(dot + 1);
+}
+
+void ExtensionIndex::add(const EntryId id, const std::wstring& lowerCaseName) {
+  EntryBitmap* bitmap = getBitmap(lowerCaseName);
+  if (bitmap != nullptr) {
+    bitmap->add(id);
+  }
+}
+
+EntryBitmap* ExtensionIndex::getBitmap(const std::wstring& lowerCaseName) {
+  std::wstring extension = getExtension(lowerCaseName);
+  return extension.empty() ? nullptr : &bitmaps[std::move(extension)];
+}
+
+EntryBitmap ExtensionIndex::getEntries(const std::vector<std::wstring>& extensions) const {
+  EntryBitmap entries;
+  for (const std::wstring& extension : extensions) {
+    std::wstring key = extension.substr(!extension.empty() && extension[0] == L'.' ? 1 : 0);
+    std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+    const auto bitmap = bitmaps.find(key);
+    if (bitmap != bitmaps.end()) {
+      entries |= bitmap->second;
+    }
+  }
+  return entries;
+}
+
+std::vector<ExtensionCount> ExtensionIndex::countExtensions(const EntryBitmap& entries,
+                                                            const size_t maxExtensions) const {
+  std::vector<ExtensionCount> counts;
+  if (entries.empty()) {
+    return counts;
+  }
+  for (const auto& [extension, bitmap] : bitmaps) {
+    const size_t count = bitmap.countIntersection(entries);
+    if (count > 0) {
+      counts.push_back({extension, count});
+    }
+  }
+  auto moreCommon = [](const ExtensionCount& a, const ExtensionCount& b) {
+    return a.count != b.count ? a.count > b.count : a.extension < b.extension;
+  };
+  if (counts.size() > maxExtensions) {
+    std::partial_sort(counts.begin(), counts.begin() + maxExtensions, counts.end(), moreCommon);
+    counts.resize(maxExtensions);
+  } else {
+    std::sort(counts.begin(), counts.end(), moreCommon);
+  }
+  return counts;
+}
+
+size_t ExtensionIndex::getMemoryUsage() const {
+  size_t bytes = bitmaps.bucket_count() * sizeof(void*);
+  for (const auto& [extension, bitmap] : bitmaps) {
+    // node: the pair and the next pointer
+    bytes += sizeof(std::pair<const std::wstring, EntryBitmap>) + sizeof(void*) +
+             bitmap.getMemoryUsage() + extension.capacity() * sizeof(wchar_t);
+  }
+  return bytes;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <finder/EntryBitmap.h>
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ExtensionCount {
+  std::wstring extension;
+  size_t count = 0;
+};
+
+/*!
+ * \brief The files of the index by their lower case extension, one EntryBitmap each.
+ *
+ * A filter on extensions is the union of their bitmaps, checking an entry against it is
+ * a lookup. Folders and names without an extension are not in the index.
+ */
+class ExtensionIndex {
+ public:
+  // longer suffixes are no extensions, e.g. "backup.2024-01-01_complete"
+  static constexpr size_t MAX_EXTENSION_LENGTH = 16;
+
+  /*!
+   * \brief The part of the lower case name after its last dot, empty if there is none.
+   * Hidden files like ".bashrc" have no extension.
+   */
+  static std::wstring getExtension(const std::wstring& lowerCaseName);
+
+  /*!
+   * \brief Add a file while building, fastest in increasing order of the ids.
+   */
+  void add(const EntryId id, const std::wstring& lowerCaseName);
+
+  /*!
+   * \brief The bitmap a name is added to, nullptr if it has no extension. For building
+   * from names shared by many entries, the extension is taken apart only once.
+   */
+  EntryBitmap* getBitmap(const std::wstring& lowerCaseName);
+
+  /*!
+   * \brief The files with any of the given extensions, which may start with a dot.
+   */
+  EntryBitmap getEntries(const std::vector<std::wstring>& extensions) const;
+
+  /*!
+   * \brief How many of the entries have each extension, the maxExtensions most common
+   * ones first. Costs about as much as the smaller of each extension and the entries.
+   */
+  std::vector<ExtensionCount> countExtensions(const EntryBitmap& entries,
+                                              const size_t maxExtensions) const;
+
+  size_t size() const { return bitmaps.size(); }
+  size_t getMemoryUsage() const;
+
+ private:
+  std::unordered_map<std::wstring, EntryBitmap> bitmaps;
+};
@@ -1,22 +1,105 @@
 #include <finder/Finder.h>
 
+#include <algorithm>
 #include <cmath>
 #include <filesystem>
+#include <fstream>
 #include <functional>
 #include <globals/globals.hpp>
+#include <globals/instrumentation.hpp>
 #include <globals/macros.hpp>
 #include <globals/timer.hpp>
+#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <settings/sanitizers.hpp>
+#include <sstream>
 #include <thread>
+#include <unordered_set>
 #include <utils/filesystem/filesystem.hpp>
 
 #ifdef _WIN32
 #include "fileapi.h"
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
+namespace {
+/*!
+ * \brief Flush the content of a file (or the entries of a directory) to the disk.
+ * Without it a crash shortly after a rename can leave an empty file behind.
+ */
+bool syncToDisk(const std::filesystem::path& path, const bool isDirectory) {
+#ifdef _WIN32
+  if (isDirectory) {
+    return true;  // MoveFileEx used by rename is durable enough on NTFS
+  }
+  HANDLE handle = CreateFileW(
+    path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  const bool synced = FlushFileBuffers(handle) != 0;
+  CloseHandle(handle);
+  return synced;
+#else
+  const int fd = ::open(path.c_str(), isDirectory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  const bool synced = ::fsync(fd) == 0;
+  ::close(fd);
+  return synced;
+#endif
+}
+
+int64_t getSecondsSinceEpoch() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+           std::chrono::system_clock::now().time_since_epoch())
+    .count();
+}
+
+/*!
+ * \brief Whether the entry is a folder (links followed, like entry.status()), and its
+ * size and modification time. Costs no more than the status of the entry alone.
+ */
+bool readStatus(const std::filesystem::directory_entry& entry, EntryMetadata& metadata) {
+#ifdef _WIN32
+  // the directory iteration read all of it already
+  std::error_code ec;
+  const bool isDirectory = std::filesystem::is_directory(entry.status());
+  const uintmax_t size   = isDirectory ? 0 : entry.file_size(ec);
+  metadata.size          = ec ? 0 : size;
+  const auto time        = entry.last_write_time(ec);
+  if (!ec) {
+    metadata.modificationTime =
+      std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::clock_cast<std::chrono::system_clock>(time).time_since_epoch())
+        .count();
+  }
+  return isDirectory;
+#else
+  struct stat status;
+  if (::stat(entry.path().c_str(), &status) != 0) {
+    return false;  // e.g. a broken link
+  }
+  const bool isDirectory    = S_ISDIR(status.st_mode);
+  metadata.size             = isDirectory ? 0 : static_cast<uint64_t>(status.st_size);
+  metadata.modificationTime = static_cast<int64_t>(status.st_mtime);
+  return isDirectory;
+#endif
+}
+}  // namespace
+
 Finder::Finder()
-    : FinderSettings(Globals::getInstance().getPath2fScoutSettings()) {
+    : Finder(Persistence::READ_WRITE) {}
+
+Finder::Finder(const Persistence persistence, const std::filesystem::path& settingsFile)
+    : FinderSettings(settingsFile.empty() ? Globals::getInstance().getPath2fScoutSettings()
+                                          : settingsFile),
+      persistence(persistence) {
   setDefaultSearchExceptions();
   put<bool>(&useWildcardPattern, USE_WILDCARD_PATTERN, true);
   put<wchar_t>(&wildcard, WILDCARD_PATTERN, true);
@@ -25,8 +108,26 @@ Finder::Finder()
   put<bool>(&searchHiddenObjects, SEACH_HIDDEN_OBJECTS, true);
   put<float>(&fuzzyCoefficient, FUZZY_SEARCH_COEFF, true, util::saneMinMax, MIN_FUZZY_COEFF, MAX_FUZZY_COEFF);
   put<std::unordered_set<std::wstring>>(&exceptions, SEACH_EXEPTIONS, true);
+  put<size_t>(&searchTimeLimitMs, SEARCH_TIME_LIMIT, true);
+  put<size_t>(&searchMaxNodesVisited, SEARCH_MAX_NODES, true);
+  put<bool>(&cacheIndex, CACHE_INDEX, true);
+  put<size_t>(&autoSaveIntervalMinutes, AUTO_SAVE_INTERVAL, true);
+  put<size_t>(&autoSaveMinChanges, AUTO_SAVE_MIN_CHANGES, true);
+  put<bool>(&compressIndex, COMPRESS_INDEX, true);
+  put<bool>(&indexMetadata, INDEX_METADATA, true);
+  put<bool>(&rankByOpenHistory, RANK_BY_OPEN_HISTORY, true);
+  if (persistence == Persistence::READ_ONLY) {
+    // cached indexes are still loaded, only never written
+    cacheIndex = false;
+  }
+  loadOpenHistory();
+}
+Finder::~Finder() {
+  joinWorkers();
+  if (persistence == Persistence::READ_WRITE) {
+    save();
+  }
 }
-Finder::~Finder() { save(); }
 
 void Finder::setDefaultSearchExceptions() {
   // Version control directories (Git): Contains repo metadata and history, not useful for search
@@ -112,25 +213,42 @@ void Finder::setDefaultSearchExceptions() {
 }
 
 bool Finder::isInitiated() const { return fullyIndexed; }
-bool Finder::isWorking() const {
-  if (workerThread && workerThread->joinable()) {
-    return true;
-  }
-  return false;
-}
+bool Finder::isWorking() const { return isIndexing() || isSearching(); }
+bool Finder::isIndexing() const { return indexWorker.isWorking(); }
+bool Finder::isSearching() const { return searchWorker.isWorking(); }
 std::filesystem::path Finder::getRootFolder() const { return root; }
-size_t Finder::getNumEntries() const { return numEntries; }
+size_t Finder::getNumEntries() const {
+  const auto dict = getDictionary();
+  return dict ? dict->getSize() : 0;
+}
 
-void Finder::stopCurrentWorker() {
-  if (workerThread && workerThread->joinable()) {
-    stopWorking.store(true);
-    workerThread->join();
-    workerThread.reset();
-  }
-  stopWorking = false;
+void Finder::stopIndexing() { indexWorker.cancel(); }
+void Finder::stopSearching() { searchWorker.cancel(); }
+void Finder::joinWorkers() {
+  // A cancelled crawl may still hand a checkpoint to the save worker, so it goes first.
+  indexWorker.stop();
+  searchWorker.stop();
+  // A running save is finished, otherwise everything since the previous checkpoint
+  // would be lost on exit. A crawl is not checkpointed when stopped.
+  saveWorker.wait();
+  historySaveWorker.wait();
+}
+
+std::shared_ptr<const Dictionary> Finder::getDictionary() const {
+  std::lock_guard<std::mutex> lock(dictionaryMutex);
+  return dictionary;
+}
+
+void Finder::publishDictionary(std::shared_ptr<const Dictionary> dict,
+                               const std::chrono::steady_clock::time_point& timeOfIndexing) {
+  std::lock_guard<std::mutex> lock(dictionaryMutex);
+  dictionary   = std::move(dict);
+  indexingTime = timeOfIndexing;
+  fullyIndexed = dictionary != nullptr;
 }
 
-bool Finder::shouldIndexEntry(const std::filesystem::directory_entry& entry) const {
+bool Finder::shouldIndexEntry(const std::filesystem::path& rootPath,
+                              const std::filesystem::directory_entry& entry) const {
   // Exclude directories or files with no read permissions
   const auto perm = std::filesystem::status(entry.path()).permissions();
   if ((perm & std::filesystem::perms::owner_read) == std::filesystem::perms::none) {
@@ -154,7 +272,8 @@ bool Finder::shouldIndexEntry(const std::filesystem::directory_entry& entry) con
   constexpr bool onUnix(true);
 #endif
   // Check if we're on Unix (Linux/macOS) and if entry is a directory at the root level
-  if (onUnix && root == std::filesystem::path("/") && entry.path().parent_path() == root) {
+  if (onUnix && rootPath == std::filesystem::path("/") &&
+      entry.path().parent_path() == rootPath) {
     constexpr wchar_t SLASH{'/'};
     if (exceptions.find(SLASH + filename) != exceptions.end()) {
       return false;
@@ -170,168 +289,432 @@ bool Finder::shouldIndexEntry(const std::filesystem::directory_entry& entry) con
 }
 
 void Finder::startIndexing(const Finder::CallbackFinnished& callback) {
+  // Starting a new job cancels a running indexing without waiting for it.
+  indexWorker.start([this, callback, rootPath = root](std::atomic<bool>& stopWorking) {
+    indexRoot(rootPath, stopWorking, callback);
+  });
+}
 
-
-
-  // Stop any currently running indexing thread
-  stopCurrentWorker();
-
-  // Reset state for new indexing
-  fullyIndexed = false;
-  dictionary   = std::make_unique<Dictionary>();
-
-  workerThread = std::make_unique<std::thread>([this, callback]() {
+void Finder::indexRoot(const std::filesystem::path& rootPath,
+                       std::atomic<bool>& stopWorking,
+                       const Finder::CallbackFinnished& callback) {
+  // The new index is build privately and only published when complete.
+  // Until then searches continue on the previously published index (if any).
+  auto newDictionary = std::make_shared<Dictionary>();
+  size_t numEntries  = 0;
 
 #ifdef _WIN32
-    auto isJunction = [](const auto& entry) {
-      // Check for junctions on Windows (treat them like symlinks)
-      DWORD attributes = GetFileAttributesW(entry.path().c_str());
-      return attributes != INVALID_FILE_ATTRIBUTES &&
-             (attributes & FILE_ATTRIBUTE_REPARSE_POINT);
-    };
+  auto isJunction = [](const auto& entry) {
+    // Check for junctions on Windows (treat them like symlinks)
+    DWORD attributes = GetFileAttributesW(entry.path().c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES &&
+           (attributes & FILE_ATTRIBUTE_REPARSE_POINT);
+  };
 #else
-    auto isJunction = [](const auto&) { return false; };
+  auto isJunction = [](const auto&) { return false; };
 #endif
 
-    // List of directories to explore
-    std::vector<std::filesystem::path> directoriesToExplore = {this->root};
-    const std::chrono::milliseconds updateTime(40);
-    Timer t;
-    t.start();
-    Timer t2;
-    t2.start();
-    while (!directoriesToExplore.empty() && !stopWorking) {
-      std::filesystem::path currentPath = directoriesToExplore.back();
-      directoriesToExplore.pop_back();
-
-      try {
-        for (const auto& entry : std::filesystem::directory_iterator(currentPath)) {
-          if (stopWorking) {
-            callback(false, L"Stopped by User.");
-            return;
-          }
+  // List of directories to explore
+  std::vector<std::filesystem::path> directoriesToExplore = {rootPath};
+  const std::chrono::milliseconds updateTime(40);
+  Timer t;
+  t.start();
+  Timer t2;
+  t2.start();
+  Timer checkpointTimer;
+  checkpointTimer.start();
+  while (!directoriesToExplore.empty() && !stopWorking) {
+    INSTRUMENT_SCOPE(CRAWL_DIRECTORY);
+    std::filesystem::path currentPath = directoriesToExplore.back();
+    directoriesToExplore.pop_back();
+
+    try {
+      for (const auto& entry : std::filesystem::directory_iterator(currentPath)) {
+        if (stopWorking) {
+          return;  // cancelled by the owner, not a failure to report
+        }
 
-          if (!shouldIndexEntry(entry)) {
-            continue;
-          }
+        if (!shouldIndexEntry(rootPath, entry)) {
+          continue;
+        }
 
-          const bool isDirectory = std::filesystem::is_directory(entry.status());
+        EntryMetadata metadata;
+        const bool isDirectory = indexMetadata ? readStatus(entry, metadata)
+                                               : std::filesystem::is_directory(entry.status());
 
-          // dont folow symlinks/junctions, they could create a circle!
-          if (!isJunction(entry) && isDirectory &&
-              !std::filesystem::is_symlink(entry.status())) {
-            directoriesToExplore.push_back(entry.path());
-          }
-          dictionary->addPath(entry.path(), isDirectory);
+        // dont folow symlinks/junctions, they could create a circle!
+        // status() follows the link, symlink_status() is the link itself
+        if (!isJunction(entry) && isDirectory && !entry.is_symlink()) {
+          directoriesToExplore.push_back(entry.path());
+        }
+        const EntryId id = newDictionary->addPath(entry.path(), isDirectory);
+        if (indexMetadata) {
+          newDictionary->setMetadata(id, metadata);
+        }
 
-          ++numEntries;
-          if (t.getPassedTime<std::chrono::milliseconds>() > updateTime) {
-            t.start();
-            callback(true, std::to_wstring(numEntries) + L" entries found");
+        ++numEntries;
+        if (t.getPassedTime<std::chrono::milliseconds>() > updateTime) {
+          t.start();
+          callback(true, false, std::to_wstring(numEntries) + L" entries found");
+
+          // Checkpoint long crawls, so a crash does not lose all the work.
+          // Only if it holds more than the cached index, the old one might be complete.
+          const auto minutesSinceCheckpoint =
+            static_cast<size_t>(checkpointTimer.getPassedTime<std::chrono::minutes>().count());
+          if (cacheIndex && minutesSinceCheckpoint >= autoSaveIntervalMinutes &&
+              numEntries >= numEntriesSaved + autoSaveMinChanges) {
+            checkpointTimer.start();
+            // the copy lets the crawl continue while the snapshot gets written
+            std::shared_ptr<Dictionary> snapshot = newDictionary->clone();
+            snapshot->finalize(compressIndex);
+            saveSnapshot(std::move(snapshot),
+                         std::chrono::steady_clock::now(),
+                         getIndexCacheFile(rootPath),
+                         nullptr);
           }
         }
-      } catch (const std::filesystem::filesystem_error& e) {
-        std::cerr << "Skipping directory due to error: " << e.what() << std::endl;
-        continue;
       }
+    } catch (const std::filesystem::filesystem_error& e) {
+      std::cerr << "Skipping directory due to error: " << e.what() << std::endl;
+      continue;
     }
+  }
+
+  if (stopWorking) {
+    return;
+  }
 
-    fullyIndexed = true;
-    indexingTime = std::chrono::steady_clock::now();
-    callback(true,
-             std::to_wstring(numEntries) + L" entries found within " +
-               std::to_wstring(t2.getPassedTime<std::chrono::milliseconds>().count()) +
-               L"ms");
+  newDictionary->finalize(compressIndex);
+  publishDictionary(std::move(newDictionary), std::chrono::steady_clock::now());
+  callback(true,
+           true,
+           std::to_wstring(numEntries) + L" entries found within " +
+             std::to_wstring(t2.getPassedTime<std::chrono::milliseconds>().count()) +
+             L"ms");
+
+  if (cacheIndex) {
+    saveCurrentIndex(getIndexCacheFile(rootPath));
+  }
+}
+
+void Finder::loadCachedIndex(const std::filesystem::path& path_to_root,
+                             const Finder::CallbackFinnished& callback) {
+  root = path_to_root;
+  searchWorker.cancel();
+  publishDictionary(nullptr, std::chrono::steady_clock::time_point());
+  numEntriesSaved = 0;
+
+  indexWorker.start([this, callback, rootPath = root](std::atomic<bool>& stopWorking) {
+    const auto cacheFile = getIndexCacheFile(rootPath);
+    // This is on the startup path, so only the header is validated. The content
+    // is bounds checked while parsing and gets replaced by the crawl below anyway.
+    if (std::filesystem::exists(cacheFile)) {
+      if (loadIndexFromFile(cacheFile, IndexValidation::HEADER_ONLY)) {
+        numEntriesSaved = getNumEntries();
+        callback(true, true, L"Loaded cached index of " + rootPath.wstring());
+      } else if (persistence == Persistence::READ_WRITE) {
+        // outdated or broken, it would fail on every start
+        std::error_code ec;
+        std::filesystem::remove(cacheFile, ec);
+      }
+    }
+    if (stopWorking) {
+      return;
+    }
+    // Freshness check: the cached index stays searchable while we crawl again.
+    // Once done the fresh index replaces it and gets cached.
+    indexRoot(rootPath, stopWorking, callback);
   });
 }
 
+void Finder::reindex(const Finder::CallbackFinnished& callback) {
+  if (root.empty()) {
+    return;
+  }
+  startIndexing(callback);
+}
+
+std::filesystem::path Finder::getIndexCacheFile(const std::filesystem::path& rootPath) {
+  std::error_code ec;
+  std::filesystem::path canonicalRoot = std::filesystem::weakly_canonical(rootPath, ec);
+  if (ec) {
+    canonicalRoot = rootPath;
+  }
+
+  // FNV-1a: stable over program runs and platforms, unlike std::hash
+  constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+  constexpr uint64_t FNV_PRIME        = 1099511628211ULL;
+  uint64_t hash                       = FNV_OFFSET_BASIS;
+  for (const wchar_t c : canonicalRoot.wstring()) {
+    hash ^= static_cast<uint64_t>(c);
+    hash *= FNV_PRIME;
+  }
+
+  std::wostringstream fileName;
+  fileName << std::hex << std::setw(16) << std::setfill(L'0') << hash << L"_"
+           << Globals::getInstance().getBinaryFileIndex();
+  return Globals::getInstance().getAbsPath2IndexCache() / fileName.str();
+}
+
 void Finder::setRootPath(const std::filesystem::path& path_to_root,
                          const Finder::CallbackFinnished& callback) {
   if (root == path_to_root) {
     return;
   }
   root = path_to_root;
+  // results of the old root are meaningless now
+  searchWorker.cancel();
+  publishDictionary(nullptr, std::chrono::steady_clock::time_point());
+  numEntriesSaved = 0;
   startIndexing(callback);
 }
 
-bool Finder::saveCurrentIndex(const std::filesystem::path& filePath) {
-  if (!fullyIndexed || !dictionary) {
+bool Finder::saveCurrentIndex(const std::filesystem::path& filePath,
+                              const CallbackSaved& callback) {
+  std::shared_ptr<const Dictionary> dict;
+  std::chrono::steady_clock::time_point timeOfIndexing;
+  {
+    std::lock_guard<std::mutex> lock(dictionaryMutex);
+    dict           = dictionary;
+    timeOfIndexing = indexingTime;
+  }
+  if (!dict) {
     std::cerr << "Index is not fully built, or no dictionary available to save."
               << std::endl;
     return false;
   }
+  // The published index is never modified, so it is a consistent snapshot already.
+  saveSnapshot(std::move(dict), timeOfIndexing, filePath, callback);
+  return true;
+}
 
+void Finder::saveSnapshot(std::shared_ptr<const Dictionary> snapshot,
+                          const std::chrono::steady_clock::time_point& timeOfIndexing,
+                          const std::filesystem::path& filePath,
+                          const CallbackSaved& callback) {
+  saveWorker.start([this, snapshot, timeOfIndexing, filePath, callback](
+                     std::atomic<bool>& stopWorking) {
+    try {
+      if (!writeIndexAtomically(*snapshot, timeOfIndexing, filePath, stopWorking)) {
+        return;  // cancelled, a newer save or the shutdown took over
+      }
+      numEntriesSaved = snapshot->getSize();
+      if (callback) {
+        callback(true, L"Index saved to " + filePath.wstring());
+      }
+    } catch (const std::exception& e) {
+      std::cerr << "Failed to save index: " << e.what() << std::endl;
+      if (callback) {
+        callback(false, L"Failed to save index to " + filePath.wstring());
+      }
+    }
+  });
+}
+
+bool Finder::writeIndexAtomically(const Dictionary& dict,
+                                  const std::chrono::steady_clock::time_point& timeOfIndexing,
+                                  const std::filesystem::path& filePath,
+                                  const std::atomic<bool>& stop) {
+  std::filesystem::path tmpFile = filePath;
+  tmpFile += L".tmp" + std::to_wstring(saveCounter.fetch_add(1));
+
+  std::error_code ec;
   try {
-    dictionary->serialize(filePath, indexingTime);  // Use Dictionary serialization
+    if (!dict.serialize(tmpFile, timeOfIndexing, &stop)) {
+      std::filesystem::remove(tmpFile, ec);
+      return false;
+    }
+    if (!syncToDisk(tmpFile, false)) {
+      throw std::runtime_error("Could not sync " + tmpFile.string() + " to disk");
+    }
+    // atomic: readers see either the old or the new complete index
+    std::filesystem::rename(tmpFile, filePath);
+    syncToDisk(filePath.parent_path(), true);
     return true;
-  } catch (const std::exception& e) {
-    std::cerr << "Failed to save index: " << e.what() << std::endl;
-    return false;
+  } catch (...) {
+    std::filesystem::remove(tmpFile, ec);
+    throw;
   }
 }
 
-bool Finder::loadIndexFromFile(const std::filesystem::path& filePath) {
+bool Finder::loadIndexFromFile(const std::filesystem::path& filePath,
+                               const IndexValidation validation) {
   if (!std::filesystem::exists(filePath)) {
     std::cerr << "The specified index file does not exist." << std::endl;
     return false;
   }
 
   try {
-    dictionary = std::make_unique<Dictionary>();
-    dictionary->deserialize(filePath, &indexingTime);  // Use Dictionary deserialization
-    fullyIndexed = true;
+    auto dict = std::make_shared<Dictionary>();
+    std::chrono::steady_clock::time_point timeOfIndexing;
+    dict->deserialize(filePath, &timeOfIndexing, validation);
+    publishDictionary(std::move(dict), timeOfIndexing);
     return true;
   } catch (const std::exception& e) {
     std::cerr << "Failed to load index: " << e.what() << std::endl;
-    dictionary.reset();  // Clear dictionary if loading failed
     return false;
   }
 }
 
 void Finder::search(const std::wstring needle /*intentional copy*/,
-                    const CallbackSearchResult& callback) {
-  if (!fullyIndexed) {
-    callback(true, {}, needle);
+                    const CallbackSearchResult& callback,
+                    const std::optional<SearchBudget>& searchBudget,
+                    const size_t maxResults) {
+  // keep our own reference: a finishing reindexing may publish a new index meanwhile
+  const auto dict = getDictionary();
+  if (!dict) {
+    auto result      = std::make_shared<SearchResult>();
+    result->finished = true;
+    result->needle   = needle;
+    callback(result);
     return;
   }
   constexpr size_t DYNAMIC_LOAD_THRESHOLD = 512;
   constexpr size_t VECTOR_RESERVE_SIZE    = 2048;
-  stopCurrentWorker();
-  workerThread = std::make_unique<std::thread>([this, callback, needle]() {
-    std::vector<TreeNode::PathInfo> matches;
+  // with more changes than this the complete ranking is cheaper to apply
+  constexpr size_t MAX_RESULT_CHANGES = 256;
+  // extensions counted for the finished results
+  constexpr size_t MAX_EXTENSION_COUNTS = 8;
+  // the budget starts with the keystroke, not when the previous search is cancelled
+  const SearchBudget budget = searchBudget.value_or(SearchBudget::fromNow(
+    std::chrono::milliseconds(searchTimeLimitMs), searchMaxNodesVisited));
+  // what the search, its collector and the ranking share, they only read it
+  struct Request {
+    std::wstring needle;
+    CallbackSearchResult callback;
+    std::shared_ptr<const Dictionary> dict;
+    SearchBudget budget;
+    size_t maxResults;
+    std::shared_ptr<const OpenHistory> history;
+    int64_t now;
+  };
+  const Request request{needle,
+                        callback,
+                        dict,
+                        budget,
+                        maxResults,
+                        rankByOpenHistory ? getOpenHistory() : nullptr,
+                        getSecondsSinceEpoch()};
+  // cancels a running search without waiting for it, indexing is not affected
+  searchWorker.start([this, request](std::atomic<bool>& stopWorking) {
+    std::vector<EntryId> matches;
 
     matches.reserve(VECTOR_RESERVE_SIZE);
-    bool finnished = false;
+    std::atomic<bool> finnished  = false;
+    std::atomic<bool> incomplete = false;
 
-    auto collector =
-      std::make_unique<std::thread>([this, &callback, &needle, &matches, &finnished]() {
-        size_t num_send_matches = 0;
-        std::multimap<int, std::filesystem::path, std::greater<int>> scoredResults;
+    static constexpr size_t MAX_FUZZY_REPLACEMENTS = 2;
+    const Query query = Query::parse(request.needle, [this](const size_t length) {
+      return std::min(MAX_FUZZY_REPLACEMENTS,
+                      static_cast<size_t>(std::round(fuzzyCoefficient * length)));
+    });
 
-        auto sendResults = [&scoredResults, &needle, &callback](const bool finished) {
-          std::vector<std::filesystem::path> results;
+    auto collector = std::make_unique<std::thread>(
+      [this, &request, &query, &matches, &finnished, &incomplete, &stopWorking]() {
+        size_t num_send_matches = 0;
+        // the score of the name plus the bonus of having been opened before
+        std::multimap<int, EntryId, std::greater<int>> scoredResults;
+        // the best score of a name alone, the bonus does not raise the threshold
+        int maxMatchScore = std::numeric_limits<int>::min();
+
+        auto sendResults = [this,
+                            &request,
+                            &query,
+                            &scoredResults,
+                            &maxMatchScore,
+                            &incomplete,
+                            &stopWorking](const bool finished) {
+          INSTRUMENT_SCOPE(RANK);
+          // ranked by a metadata column: every match counts, the limit is applied after sorting
+          const bool isSorted = query.sortKey != Query::SortKey::SCORE;
+          std::vector<EntryId> results;
           results.reserve(scoredResults.size());
-          const int maxScore  = scoredResults.begin()->first;
-          const int threshold = maxScore - needle.size();
-          std::set<std::filesystem::path> seenPaths;
-          for (auto it = scoredResults.begin(); it != scoredResults.end(); ++it) {
-            const auto& [score, path] = *it;
-            if (score < threshold || !finished && results.size() > 20) {
-              break;
+          if (!scoredResults.empty()) {
+            const int maxScore  = maxMatchScore;
+            // every match of a query of several terms has all of them, some on its folders
+            const int threshold = query.isSimple()
+                                    ? maxScore - static_cast<int>(request.needle.size())
+                                    : std::numeric_limits<int>::min();
+            std::unordered_set<EntryId> seenPaths;
+            for (auto it = scoredResults.begin(); it != scoredResults.end(); ++it) {
+              const auto& [score, id] = *it;
+              if (score < threshold || !finished && results.size() > 20 ||
+                  (request.maxResults > 0 && !isSorted && results.size() >= request.maxResults)) {
+                break;
+              }
+              // If the path has not been added yet, insert it into the result
+              // The paths are only assembled by the receiver, for the rows it shows.
+              if (seenPaths.insert(id).second) {
+                results.push_back(id);
+              }
+            }
+          }
+          if (isSorted) {
+            // the largest or newest first, equal ones stay in the order of their score
+            auto getKey = [&request, &query](const EntryId id) {
+              const EntryMetadata metadata = request.dict->getMetadata(id);
+              return query.sortKey == Query::SortKey::SIZE ? static_cast<int64_t>(metadata.size)
+                                                           : metadata.modificationTime;
+            };
+            std::stable_sort(
+              results.begin(), results.end(), [&getKey](const EntryId a, const EntryId b) {
+                return getKey(a) > getKey(b);
+              });
+            if (request.maxResults > 0 && results.size() > request.maxResults) {
+              results.resize(request.maxResults);
+            }
+          }
+
+          // the facets of all matches, not only the ranked ones
+          std::vector<ExtensionCount> extensionCounts;
+          if (finished) {
+            std::vector<EntryId> matched;
+            matched.reserve(scoredResults.size());
+            for (const auto& [score, id] : scoredResults) {
+              matched.push_back(id);
             }
-            // If the path has not been added yet, insert it into the result
-            if (seenPaths.insert(path).second) {
-              results.push_back(path);
+            std::sort(matched.begin(), matched.end());
+            EntryBitmap matchedBitmap;
+            for (const EntryId id : matched) {
+              matchedBitmap.add(id);
             }
+            extensionCounts =
+              request.dict->getExtensions().countExtensions(matchedBitmap, MAX_EXTENSION_COUNTS);
+          }
+
+          // the receiver shows what we sent last, tell it only what changed. The lock keeps
+          // the updates of an outdated search and its successor in order.
+          std::lock_guard<std::mutex> lock(sentResultsMutex);
+          if (stopWorking.load()) {
+            return;  // a newer search is running, dont override its results
+          }
+          auto result        = std::make_shared<SearchResult>();
+          result->finished   = finished;
+          result->incomplete = finished && incomplete.load();
+          result->needle     = request.needle;
+          result->dictionary = request.dict;
+          result->extensionCounts = std::move(extensionCounts);
+          ResultUpdate& update = result->update;
+          if (sentResults) {
+            update.baseVersion = sentResults->update.version;
+            update.version     = sentResults->update.version + 1;
+            update.reset       = sentResults->dictionary != request.dict ||
+                           !diffResults(sentResults->update.ranking,
+                                        results,
+                                        MAX_RESULT_CHANGES,
+                                        update.changes);
+          } else {
+            update.version = 1;
           }
-          /*F_DEBUG("found %lu, unique %lu, send %lu",
-                  scoredResults.size(),
-                  seenPaths.size(),
-                  results.size());*/
-          callback(finished, results, needle);
+          if (update.reset) {
+            update.changes.clear();
+          }
+          update.ranking = std::move(results);
+          sentResults    = result;
+          request.callback(sentResults);
         };
 
-        auto holdDynamicLoading = [this, &matches, &finnished]() {
+        auto holdDynamicLoading = [&matches, &finnished, &stopWorking]() {
           if (DYNAMIC_LOAD_THRESHOLD > matches.size()) {
             return;  // dont peak into the vector which is shared between 2 treads, since it can be relocated now.
           }
@@ -359,16 +742,25 @@ void Finder::search(const std::wstring needle /*intentional copy*/,
             // this could crash if the vector gets relocated while copying.
             // hopefully holdDynamicLoading will prevent this!
             // we could also implement a thread save vector...
-            TreeNode::PathInfo match = matches[num_send_matches];
-            const auto name          = util::getLastPathComponent(match.path);
-            bool notHidden           = searchHiddenObjects || name[0] != L'.';
-
-            if (notHidden && (match.isDirectory && searchForFolderNames ||
-                              !match.isDirectory && searchForFileNames)) {
-              scoredResults.emplace(Dictionary::scoreMatch(needle, name), match.path);
+            const EntryId match     = matches[num_send_matches];
+            const std::wstring name = request.dict->getName(match);
+            if (isShown(*request.dict, match, name)) {
+              INSTRUMENT_SCOPE(SCORE);
+              const int score = Dictionary::scoreQuery(query, name);
+              maxMatchScore   = std::max(maxMatchScore, score);
+              // a lookup of the name, the path is only assembled if that name was opened
+              int bonus = 0;
+              if (request.history && !request.history->empty()) {
+                auto getPath = [&]() { return request.dict->getPath(match); };
+                bonus        = getOpenBonus(request.history->getOpens(name, getPath, request.now));
+              }
+              scoredResults.emplace(score + bonus, match);
             }
           }
           searchFinnishedAndAllSend = finnished && new_size == matches.size();
+          if (stopWorking.load()) {
+            break;  // a newer search is running, dont override its results
+          }
           if (new_size > old_size || searchFinnishedAndAllSend) {
             old_size = new_size;
             sendResults(searchFinnishedAndAllSend);
@@ -378,17 +770,35 @@ void Finder::search(const std::wstring needle /*intentional copy*/,
 
     wchar_t wildcardChar{useWildcardPattern ? wildcard : Dictionary::NO_WILDCARD};
 
-    constexpr size_t MAX_FUZZY_REPLACEMENTS = 2;
-    const size_t numFuzzyReplacements =
-      std::min(MAX_FUZZY_REPLACEMENTS,
-               static_cast<size_t>(std::round(fuzzyCoefficient * needle.size())));
-
-    Timer searchTimer;
-    searchTimer.start();
-    dictionary->search(stopWorking, needle, numFuzzyReplacements, wildcardChar, matches);
-    const auto time = searchTimer.getPassedTime<std::chrono::milliseconds>();
-    std::cout << " search: " << time.count() << "ms" << std::endl;
-    finnished = true;
+    SearchProgress progress;
+    const Query::Segment& segment = query.getSimpleSegment();
+    if (!query.isSimple()) {
+      progress =
+        request.dict->searchQuery(stopWorking, query, wildcardChar, matches, request.budget);
+    } else if (request.maxResults > 0) {
+      progress = request.dict->searchBest(
+        stopWorking,
+        segment.needle,
+        segment.numFuzzyReplacements,
+        wildcardChar,
+        request.maxResults,
+        [this, &request](const EntryId id, const std::wstring& name) {
+          return isShown(*request.dict, id, name);
+        },
+        matches,
+        request.budget,
+        // the most any result gains in the ranking below
+        request.history ? getOpenBonus(request.history->getMaxOpens(request.now)) : 0);
+    } else {
+      progress = request.dict->search(stopWorking,
+                                      segment.needle,
+                                      segment.numFuzzyReplacements,
+                                      wildcardChar,
+                                      matches,
+                                      request.budget);
+    }
+    incomplete = !progress.complete;
+    finnished  = true;
     if (collector && collector->joinable()) {
       collector->join();
       collector.reset();
@@ -397,13 +807,106 @@ void Finder::search(const std::wstring needle /*intentional copy*/,
 }
 
 
+void Finder::loadOpenHistory() {
+  auto history    = std::make_shared<OpenHistory>();
+  const auto file = Globals::getInstance().getPath2OpenHistory();
+  std::error_code ec;
+  if (std::filesystem::exists(file, ec)) {
+    try {
+      std::ifstream in(file, std::ios::binary);
+      const std::vector<char> data((std::istreambuf_iterator<char>(in)),
+                                   std::istreambuf_iterator<char>());
+      BinaryReader reader(data.data(), data.size());
+      history->deserialize(reader);
+    } catch (const std::exception& e) {
+      std::cerr << "Ignoring the open history: " << e.what() << std::endl;
+      history = std::make_shared<OpenHistory>();
+    }
+  }
+  std::lock_guard<std::mutex> lock(openHistoryMutex);
+  openHistory = std::move(history);
+}
+
+std::shared_ptr<const OpenHistory> Finder::getOpenHistory() const {
+  std::lock_guard<std::mutex> lock(openHistoryMutex);
+  return openHistory;
+}
+
+void Finder::recordOpened(const std::filesystem::path& path) {
+  std::lock_guard<std::mutex> lock(openHistoryMutex);
+  // running searches keep the previous one
+  auto history = openHistory ? std::make_shared<OpenHistory>(*openHistory)
+                             : std::make_shared<OpenHistory>();
+  history->recordOpen(path, getSecondsSinceEpoch());
+  openHistory = history;
+  if (persistence == Persistence::READ_ONLY) {
+    return;
+  }
+  // Written in the background, started under the lock so the saves keep the order of the
+  // opens. A newer open cancels the save, its history has this open in it as well.
+  historySaveWorker.start([this, history](std::atomic<bool>& stop) {
+    std::lock_guard<std::mutex> fileLock(openHistoryFileMutex);
+    if (!stop.load()) {
+      writeOpenHistory(*history);
+    }
+  });
+}
+
+void Finder::writeOpenHistory(const OpenHistory& history) const {
+  // Small, written at once. Synced before the rename, so a failed write or a crash keeps
+  // the previous one, as for the index.
+  const auto file = Globals::getInstance().getPath2OpenHistory();
+  auto tmpFile    = file;
+  tmpFile += L".tmp";
+  BinaryWriter writer;
+  history.serialize(writer);
+  std::ofstream out(tmpFile, std::ios::binary | std::ios::trunc);
+  out.write(writer.getBuffer().data(), static_cast<std::streamsize>(writer.size()));
+  out.close();
+  std::error_code ec;
+  if (!out || !syncToDisk(tmpFile, false)) {
+    std::cerr << "Could not write the open history " << tmpFile.string() << std::endl;
+    std::filesystem::remove(tmpFile, ec);
+    return;
+  }
+  std::filesystem::rename(tmpFile, file, ec);
+  if (ec) {
+    std::cerr << "Could not save the open history: " << ec.message() << std::endl;
+    std::filesystem::remove(tmpFile, ec);
+    return;
+  }
+  syncToDisk(file.parent_path(), true);
+}
+
+int Finder::getOpenBonus(const double opens) {
+  if (opens <= 0.) {
+    return 0;
+  }
+  return std::min(MAX_OPEN_BONUS,
+                  static_cast<int>(std::lround(Dictionary::MAX_CHAR_SCORE * std::log2(1. + opens))));
+}
+
+void Finder::setRankByOpenHistory(const bool rank) { rankByOpenHistory = rank; }
+bool Finder::isSetRankByOpenHistory() const { return rankByOpenHistory; }
+
+bool Finder::isShown(const Dictionary& dict, const EntryId id, const std::wstring& name) const {
+  const bool isDirectory = dict.isDirectory(id);
+  const bool notHidden   = searchHiddenObjects || name[0] != L'.';
+  return notHidden && ((isDirectory && searchForFolderNames) || (!isDirectory && searchForFileNames));
+}
+
 std::wstring Finder::getIndexingDate() const {
-  if (!fullyIndexed) {
-    return L"Not indexed yet";
+  std::chrono::steady_clock::time_point timeOfIndexing;
+  {
+    std::lock_guard<std::mutex> lock(dictionaryMutex);
+    if (!dictionary) {
+      return L"Not indexed yet";
+    }
+    timeOfIndexing = indexingTime;
   }
 
   auto timeT = std::chrono::system_clock::to_time_t(
-    std::chrono::system_clock::now() + (indexingTime - std::chrono::steady_clock::now()));
+    std::chrono::system_clock::now() + (timeOfIndexing - std::chrono::steady_clock::now()));
 
   std::tm* timeStruct = std::localtime(&timeT);
 
@@ -437,6 +940,17 @@ bool Finder::isSetSearchFolderNames() const { return searchForFolderNames; }
 bool Finder::isSetSearchHiddenObjects() const { return searchHiddenObjects; }
 
 float Finder::getFuzzyCoefficient() const { return fuzzyCoefficient; }
+
+void Finder::setSearchTimeLimit(const std::chrono::milliseconds timeLimit) {
+  searchTimeLimitMs = static_cast<size_t>(std::max<std::chrono::milliseconds::rep>(timeLimit.count(), 0));
+}
+void Finder::setSearchMaxNodesVisited(const size_t maxNodes) {
+  searchMaxNodesVisited = maxNodes;
+}
+std::chrono::milliseconds Finder::getSearchTimeLimit() const {
+  return std::chrono::milliseconds(searchTimeLimitMs);
+}
+size_t Finder::getSearchMaxNodesVisited() const { return searchMaxNodesVisited; }
 void Finder::setFuzzyCoefficient(const float fuzzy) {
   fuzzyCoefficient = fuzzy;
 }
@@ -1,13 +1,19 @@
 #pragma once
 
 #include <finder/Dictionary.h>
+#include <finder/OpenHistory.h>
+#include <finder/SearchBudget.h>
 #include <finder/SearchPattern.h>
+#include <finder/SearchResult.h>
+#include <finder/Worker.h>
 
 #include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <settings/settings.hpp>
 #include <string>
@@ -17,29 +23,91 @@ using FinderSettings =
   util::Settings<std::variant<bool*, float*, size_t*, wchar_t*, std::unordered_set<std::wstring>*>>;
 class Finder : public FinderSettings {
   std::filesystem::path root = std::filesystem::path();
-  bool fullyIndexed          = false;
-  std::unique_ptr<Dictionary> dictionary;
-  std::unique_ptr<std::thread> workerThread;
-  std::atomic<bool> stopWorking = false;
+  std::atomic<bool> fullyIndexed = false;
 
-  using CallbackFinnished = std::function<void(const bool, const std::wstring& msg)>;
-  using CallbackSearchResult =
-    std::function<void(const bool, const std::vector<std::filesystem::path>&, const std::wstring&)>;
-  size_t numEntries = 0;
+  // The published index. It is never modified after publishing, indexing builds a new one.
+  // Searches keep their own reference, so a finished reindexing can swap it at any time.
+  std::shared_ptr<const Dictionary> dictionary;
+  std::chrono::steady_clock::time_point indexingTime;
+  mutable std::mutex dictionaryMutex;
+
+  // success, finished, message. A cancelled indexing (a new root, stopIndexing, the
+  // shutdown) does not call back: it was requested, so there is nothing to report.
+  using CallbackFinnished =
+    std::function<void(const bool, const bool, const std::wstring& msg)>;
+  // the results as changes against the previous ones, shared and never modified
+  using CallbackSearchResult = std::function<void(const std::shared_ptr<const SearchResult>&)>;
+  // success, message
+  using CallbackSaved = std::function<void(const bool, const std::wstring& msg)>;
 
  public:
+  /*!
+   * \brief How a Finder treats the files it shares with the GUI: its settings, the
+   * index cache and the open history.
+   */
+  enum class Persistence {
+    // read and written, the GUI
+    READ_WRITE,
+    // only read, tools running next to the GUI must not overwrite its state
+    READ_ONLY,
+  };
+
   Finder();
+  /*!
+   * \param settingsFile Empty for the settings of the GUI.
+   */
+  explicit Finder(const Persistence persistence, const std::filesystem::path& settingsFile = {});
   ~Finder();
   bool isInitiated() const;
   bool isWorking() const;
-  void stopCurrentWorker();
+  bool isIndexing() const;
+  bool isSearching() const;
+  void stopIndexing();
+  void stopSearching();
+  /*!
+   * \brief Stop indexing and searching and wait for the threads. A running index save
+   * is finished first, it holds the last checkpoint, and so is the save of the open
+   * history.
+   */
+  void joinWorkers();
   size_t getNumEntries() const;
   std::filesystem::path getRootFolder() const;
 
   void setRootPath(const std::filesystem::path&, const CallbackFinnished&);
 
-  bool saveCurrentIndex(const std::filesystem::path&);
-  bool loadIndexFromFile(const std::filesystem::path&);
+  /*!
+   * \brief Set the root and load its cached index (if any) in the background.
+   * Afterwards the root is crawled again to bring the index up to date. The cached
+   * index stays searchable until the fresh one replaces it.
+   */
+  void loadCachedIndex(const std::filesystem::path&, const CallbackFinnished&);
+
+  /*!
+   * \brief Crawl the root again in the background. The current index stays searchable
+   * until the fresh one replaces it. Does nothing if no root is set.
+   */
+  void reindex(const CallbackFinnished&);
+
+  /*!
+   * \brief Returns the file inside the index cache folder used for the given root.
+   * The name is derived from a hash of the canonical root path.
+   */
+  static std::filesystem::path getIndexCacheFile(const std::filesystem::path& rootPath);
+
+  /*!
+   * \brief Save the current index in the background.
+   * The index is written into a temporary file, synced to disk and then renamed
+   * over the given file. A crash or a cancellation never leaves a broken index behind.
+   * A save which is still running gets cancelled.
+   * \return false if there is no index to save.
+   */
+  bool saveCurrentIndex(const std::filesystem::path&, const CallbackSaved& callback = nullptr);
+  /*!
+   * \brief Load an index file and make it the current index.
+   * \param validation HEADER_ONLY skips the checksums of the content.
+   */
+  bool loadIndexFromFile(const std::filesystem::path&,
+                         const IndexValidation validation = IndexValidation::FULL);
 
   bool usesWildcardPattern() const;
   wchar_t getWindcard() const;
@@ -55,22 +123,85 @@ class Finder : public FinderSettings {
   bool isSetSearchHiddenObjects() const;
   float getFuzzyCoefficient() const;
 
+  /*!
+   * \brief Limit the time of a search from its start to its final results, and the
+   * tree nodes it may visit. Zero means unlimited. A search running out of budget sends
+   * the best matches found until then as finished and incomplete results.
+   */
+  void setSearchTimeLimit(const std::chrono::milliseconds timeLimit);
+  void setSearchMaxNodesVisited(const size_t maxNodes);
+  std::chrono::milliseconds getSearchTimeLimit() const;
+  size_t getSearchMaxNodesVisited() const;
+
+
+  /*!
+   * \brief Search in the background, the callback gets the results as they improve.
+   * \param budget Limits this search instead of the search time limit settings.
+   * \param maxResults If not 0, only the best results are wanted: they are searched
+   * best-first and the search ends once they are certain, see Dictionary::searchBest().
+   * The bonus of opened results is accounted for, the more a result was opened the
+   * more has to be explored before the best are certain.
+   */
+  void search(const std::wstring needle,
+              const CallbackSearchResult&,
+              const std::optional<SearchBudget>& budget = std::nullopt,
+              const size_t maxResults                   = 0);
 
-  void search(const std::wstring needle, const CallbackSearchResult&);
+  /*!
+   * \brief Count an open of a result. Results opened often and recently rank higher,
+   * see OpenHistory. The history is saved in the background, joinWorkers() waits for it.
+   */
+  void recordOpened(const std::filesystem::path& path);
+  /*!
+   * \brief The score a result gains from being opened before: one well matching character
+   * per doubling of its decayed opens, at most MAX_OPEN_BONUS.
+   */
+  static int getOpenBonus(const double opens);
+  void setRankByOpenHistory(const bool rank);
+  bool isSetRankByOpenHistory() const;
 
   std::wstring getIndexingDate() const;
 
+  /*!
+   * \brief Statistics of the searchable index, empty if there is none yet.
+   */
+  IndexStatistics getIndexStatistics() const {
+    const auto dict = getDictionary();
+    return dict ? dict->getStatistics() : IndexStatistics();
+  }
+
   void visualize() const {
-    if (dictionary == nullptr) {
+    const auto dict = getDictionary();
+    if (dict == nullptr) {
       return;
     }
-    dictionary->visualize();
+    dict->visualize();
   }
 
  private:
   void setDefaultSearchExceptions();
-  bool shouldIndexEntry(const std::filesystem::directory_entry& entry) const;
+  bool shouldIndexEntry(const std::filesystem::path& rootPath,
+                        const std::filesystem::directory_entry& entry) const;
+  // hidden, file and folder settings, name is the name of the entry
+  bool isShown(const Dictionary& dict, const EntryId id, const std::wstring& name) const;
+  void loadOpenHistory();
+  void writeOpenHistory(const OpenHistory& history) const;
+  std::shared_ptr<const OpenHistory> getOpenHistory() const;
   void startIndexing(const CallbackFinnished&);
+  void indexRoot(const std::filesystem::path& rootPath,
+                 std::atomic<bool>& stopWorking,
+                 const CallbackFinnished& callback);
+  void saveSnapshot(std::shared_ptr<const Dictionary> snapshot,
+                    const std::chrono::steady_clock::time_point& timeOfIndexing,
+                    const std::filesystem::path& filePath,
+                    const CallbackSaved& callback);
+  bool writeIndexAtomically(const Dictionary& dict,
+                            const std::chrono::steady_clock::time_point& timeOfIndexing,
+                            const std::filesystem::path& filePath,
+                            const std::atomic<bool>& stop);
+  std::shared_ptr<const Dictionary> getDictionary() const;
+  void publishDictionary(std::shared_ptr<const Dictionary> dict,
+                         const std::chrono::steady_clock::time_point& timeOfIndexing);
 
   // SETTINGS
   float fuzzyCoefficient                 = 0.25f;
@@ -85,12 +216,56 @@ class Finder : public FinderSettings {
   const std::string SEACH_FILES          = "SearchFiles";
   bool searchHiddenObjects               = false;
   const std::string SEACH_HIDDEN_OBJECTS = "SearchHiddenObjects";
+  // zero: unlimited, see setSearchTimeLimit()
+  size_t searchTimeLimitMs               = 0;
+  const std::string SEARCH_TIME_LIMIT    = "SearchTimeLimitMs";
+  size_t searchMaxNodesVisited           = 0;
+  const std::string SEARCH_MAX_NODES     = "SearchMaxNodesVisited";
   std::unordered_set<std::wstring> exceptions;
   const std::string SEACH_EXEPTIONS = "SearchExceptions";
+  // always false when read only
+  bool cacheIndex                    = true;
+  const std::string CACHE_INDEX      = "CacheIndex";
+  // while crawling, checkpoint the partial index into the cache after this many minutes...
+  size_t autoSaveIntervalMinutes       = 5;
+  const std::string AUTO_SAVE_INTERVAL = "AutoSaveIntervalMinutes";
+  // ...if at least this many entries were added since the last save
+  size_t autoSaveMinChanges               = 10000;
+  const std::string AUTO_SAVE_MIN_CHANGES = "AutoSaveMinChanges";
+  // huffman code the front coded names in the index, smaller but a bit slower to decode
+  bool compressIndex               = true;
+  const std::string COMPRESS_INDEX = "CompressIndex";
+  // store size and modification time of every entry, for the size: and modified: filters
+  bool indexMetadata               = true;
+  const std::string INDEX_METADATA = "IndexMetadata";
+  bool rankByOpenHistory                 = true;
+  const std::string RANK_BY_OPEN_HISTORY = "RankByOpenHistory";
 
-  std::chrono::steady_clock::time_point indexingTime;
+  const Persistence persistence;
+
+  // replaced on every open, searches keep the one they started with
+  std::shared_ptr<const OpenHistory> openHistory;
+  mutable std::mutex openHistoryMutex;
+  // one save of the history file at a time
+  std::mutex openHistoryFileMutex;
+
+  // the results last sent to a search callback, the next update is a diff against them
+  std::shared_ptr<const SearchResult> sentResults;
+  std::mutex sentResultsMutex;
+
+  // number of entries of the index last written into the cache
+  std::atomic<size_t> numEntriesSaved = 0;
+  // makes the temporary file names unique, a cancelled save might still write its file
+  std::atomic<size_t> saveCounter = 0;
+
+  // declared last: the workers must be destroyed (joined) before anything their jobs use
+  Worker indexWorker;
+  Worker searchWorker;
+  Worker saveWorker;
+  Worker historySaveWorker;
 
  public:
   static constexpr float MAX_FUZZY_COEFF = 0.5f;
   static constexpr float MIN_FUZZY_COEFF = 0.f;
+  static constexpr int MAX_OPEN_BONUS    = 4 * Dictionary::MAX_CHAR_SCORE;
 };
@@ -0,0 +1,159 @@
+#include <finder/HuffmanCoder.h>
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+void HuffmanCoder::build(const std::array<uint64_t, NUM_SYMBOLS>& frequencies) {
+  std::array<uint64_t, NUM_SYMBOLS> freq = frequencies;
+
+  // Halve the frequencies until the longest code fits into MAX_CODE_LENGTH.
+  // Rare symbols get a bit more expensive, but decoding stays a single lookup.
+  while (true) {
+    struct Node {
+      uint64_t weight;
+      int left;
+      int right;
+    };
+    std::vector<Node> nodes;
+    using Item = std::pair<uint64_t, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    for (size_t symbol = 0; symbol < NUM_SYMBOLS; ++symbol) {
+      if (freq[symbol] > 0) {
+        nodes.push_back({freq[symbol], -1, static_cast<int>(symbol)});
+        queue.emplace(freq[symbol], static_cast<int>(nodes.size() - 1));
+      }
+    }
+
+    lengths.fill(0);
+    if (nodes.empty()) {
+      decodeTable.clear();
+      return;
+    }
+    if (nodes.size() == 1) {
+      lengths[nodes[0].right] = 1;
+      break;
+    }
+
+    while (queue.size() > 1) {
+      const auto [weightA, a] = queue.top();
+      queue.pop();
+      const auto [weightB, b] = queue.top();
+      queue.pop();
+      nodes.push_back({weightA + weightB, a, b});
+      queue.emplace(weightA + weightB, static_cast<int>(nodes.size() - 1));
+    }
+
+    // walk the tree to get the depth of each leaf
+    bool tooLong = false;
+    std::vector<std::pair<int, uint8_t>> stack = {{queue.top().second, 0}};
+    while (!stack.empty()) {
+      const auto [index, depth] = stack.back();
+      stack.pop_back();
+      const Node& node = nodes[index];
+      if (node.left < 0) {
+        lengths[node.right] = depth;
+        tooLong |= depth > MAX_CODE_LENGTH;
+        continue;
+      }
+      stack.emplace_back(node.left, depth + 1);
+      stack.emplace_back(node.right, depth + 1);
+    }
+    if (!tooLong) {
+      break;
+    }
+    for (auto& f : freq) {
+      if (f > 0) {
+        f = (f >> 1) | 1;
+      }
+    }
+  }
+  buildCodes();
+}
+
+void HuffmanCoder::setCodeLengths(const CodeLengths& codeLengths) {
+  lengths = codeLengths;
+  buildCodes();
+}
+
+void HuffmanCoder::buildCodes() {
+  codes.fill(0);
+  decodeTable.assign(size_t{1} << MAX_CODE_LENGTH, 0);
+
+  uint32_t code = 0;
+  for (uint8_t length = 1; length <= MAX_CODE_LENGTH; ++length) {
+    for (size_t symbol = 0; symbol < NUM_SYMBOLS; ++symbol) {
+      if (lengths[symbol] != length) {
+        continue;
+      }
+      if (code >= (uint32_t{1} << length)) {
+        decodeTable.clear();
+        throw std::runtime_error("Corrupted index: invalid huffman code lengths");
+      }
+      codes[symbol] = static_cast<uint16_t>(code);
+
+      const uint32_t shift = MAX_CODE_LENGTH - length;
+      const uint32_t first = code << shift;
+      const auto entry     = static_cast<uint16_t>(symbol | (length << 8));
+      std::fill(decodeTable.begin() + first, decodeTable.begin() + first + (1u << shift), entry);
+      ++code;
+    }
+    code <<= 1;
+  }
+  for (const uint8_t length : lengths) {
+    if (length > MAX_CODE_LENGTH) {
+      decodeTable.clear();
+      throw std::runtime_error("Corrupted index: huffman code too long");
+    }
+  }
+}
+
+void HuffmanCoder::encode(std::string_view input, std::vector<char>& out) const {
+  uint32_t bitBuffer = 0;
+  int bitCount       = 0;
+  for (const char c : input) {
+    const auto symbol = static_cast<uint8_t>(c);
+    if (lengths[symbol] == 0) {
+      throw std::logic_error("Symbol without huffman code");
+    }
+    bitBuffer = (bitBuffer << lengths[symbol]) | codes[symbol];
+    bitCount += lengths[symbol];
+    while (bitCount >= 8) {
+      bitCount -= 8;
+      out.push_back(static_cast<char>(bitBuffer >> bitCount));
+    }
+  }
+  if (bitCount > 0) {
+    out.push_back(static_cast<char>(bitBuffer << (8 - bitCount)));
+  }
+}
+
+void HuffmanCoder::decode(const char* data,
+                          const size_t dataSize,
+                          const size_t numSymbols,
+                          std::string& out) const {
+  if (numSymbols > 0 && empty()) {
+    throw std::runtime_error("Corrupted index: no huffman codes");
+  }
+  constexpr int REFILL_LIMIT     = 56;
+  constexpr uint16_t SYMBOL_MASK = 0xFF;
+
+  uint64_t bits = 0;  // valid bits are left aligned
+  int bitCount  = 0;
+  size_t next   = 0;
+  out.reserve(out.size() + numSymbols);
+  for (size_t i = 0; i < numSymbols; ++i) {
+    while (bitCount <= REFILL_LIMIT && next < dataSize) {
+      bits |= static_cast<uint64_t>(static_cast<uint8_t>(data[next++])) << (REFILL_LIMIT - bitCount);
+      bitCount += 8;
+    }
+    const uint16_t entry = decodeTable[bits >> (64 - MAX_CODE_LENGTH)];
+    const int length     = entry >> 8;
+    if (length == 0 || length > bitCount) {
+      throw std::runtime_error("Corrupted index: invalid huffman data");
+    }
+    out.push_back(static_cast<char>(entry & SYMBOL_MASK));
+    bits <<= length;
+    bitCount -= length;
+  }
+}
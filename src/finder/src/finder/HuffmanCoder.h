@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*!
+ * \brief Canonical, length limited Huffman coder for bytes.
+ *
+ * Used to squeeze the blocks of the StringPool. Only the code lengths need to be
+ * stored, the codes are rebuild from them. Decoding uses one table lookup per
+ * symbol, so decoding a block on demand stays cheap.
+ */
+class HuffmanCoder {
+ public:
+  static constexpr size_t NUM_SYMBOLS      = 256;
+  static constexpr uint8_t MAX_CODE_LENGTH = 12;
+  using CodeLengths                        = std::array<uint8_t, NUM_SYMBOLS>;
+
+  /*!
+   * \brief Build the codes from the frequency of each byte.
+   */
+  void build(const std::array<uint64_t, NUM_SYMBOLS>& frequencies);
+
+  /*!
+   * \brief Restore the codes from stored code lengths.
+   * Throws std::runtime_error if the lengths do not describe a valid code.
+   */
+  void setCodeLengths(const CodeLengths& codeLengths);
+
+  const CodeLengths& getCodeLengths() const { return lengths; }
+
+  bool empty() const { return decodeTable.empty(); }
+
+  /*!
+   * \brief Append the code of the input to out. The output is padded to full bytes.
+   */
+  void encode(std::string_view input, std::vector<char>& out) const;
+
+  /*!
+   * \brief Decode numSymbols bytes from data and append them to out.
+   * Throws std::runtime_error if data is not a valid encoding.
+   */
+  void decode(const char* data, size_t dataSize, size_t numSymbols, std::string& out) const;
+
+ private:
+  void buildCodes();
+
+  CodeLengths lengths{};
+  std::array<uint16_t, NUM_SYMBOLS> codes{};
+  // indexed by the next MAX_CODE_LENGTH bits: symbol | code length << 8, 0 for invalid
+  std::vector<uint16_t> decodeTable;
+};
@@ -0,0 +1,189 @@
+#include <finder/Crc32c.h>
+#include <finder/IndexFile.h>
+
+#include <algorithm>
+#include <cstring>
+#include <globals/globals.hpp>
+#include <stdexcept>
+
+namespace {
+// id, offset, size, checksum
+constexpr size_t SECTION_ENTRY_SIZE =
+  sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
+size_t getFixedHeaderSize() {
+  const size_t identifierBytes =
+    Globals::getInstance().getBinaryTreeFromatIdentifier().size() * sizeof(wchar_t);
+  // identifier, version, time, number of sections
+  return identifierBytes + sizeof(uint32_t) + sizeof(int64_t) + sizeof(uint32_t);
+}
+}  // namespace
+
+void IndexFileWriter::addSection(const IndexSection id, BinaryWriter&& section) {
+  sections.push_back({id, std::move(section.getBuffer())});
+}
+
+void IndexFileWriter::write(const std::filesystem::path& filename,
+                            const int64_t timeOfIndexing) const {
+  BinaryWriter header;
+  const std::wstring& identifier = Globals::getInstance().getBinaryTreeFromatIdentifier();
+  header.writeBytes(identifier.c_str(), identifier.size() * sizeof(wchar_t));
+  header.writePod(Globals::VERSION);
+  header.writePod(timeOfIndexing);
+  header.writePod(static_cast<uint32_t>(sections.size()));
+
+  uint64_t offset = getFixedHeaderSize() + sections.size() * SECTION_ENTRY_SIZE + sizeof(uint32_t);
+  for (const auto& section : sections) {
+    header.writePod(static_cast<uint32_t>(section.id));
+    header.writePod(offset);
+    header.writePod(static_cast<uint64_t>(section.data.size()));
+    header.writePod(crc32c(section.data.data(), section.data.size()));
+    offset += section.data.size();
+  }
+  header.writePod(crc32c(header.getBuffer().data(), header.size()));
+
+  std::ofstream outFile(filename, std::ios::binary);
+  if (!outFile.is_open()) {
+    throw std::runtime_error("Could not open file for serialization");
+  }
+  outFile.write(header.getBuffer().data(), static_cast<std::streamsize>(header.size()));
+  for (const auto& section : sections) {
+    outFile.write(section.data.data(), static_cast<std::streamsize>(section.data.size()));
+  }
+  outFile.close();
+  if (!outFile) {
+    throw std::runtime_error("Failed to write index into " + filename.string());
+  }
+}
+
+IndexFileReader::IndexFileReader(const std::filesystem::path& filename,
+                                 const IndexValidation validation)
+    : file(filename, std::ios::binary | std::ios::ate), validation(validation) {
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not open file for deserialization");
+  }
+  const auto fileSize = static_cast<uint64_t>(file.tellg());
+  file.seekg(0);
+
+  // the fixed part tells us how large the section table is
+  const size_t fixedSize = getFixedHeaderSize();
+  std::vector<char> header(fixedSize);
+  if (fileSize < fixedSize || !file.read(header.data(), static_cast<std::streamsize>(fixedSize))) {
+    throw std::runtime_error("Corrupted index: file too small");
+  }
+
+  BinaryReader reader(header.data(), header.size());
+  const std::wstring& identifier = Globals::getInstance().getBinaryTreeFromatIdentifier();
+  const auto identifierBytes     = identifier.size() * sizeof(wchar_t);
+  if (std::memcmp(reader.readBytes(identifierBytes).data(), identifier.c_str(), identifierBytes) != 0) {
+    throw std::runtime_error(
+      "File identifier does not match. This file may not be serialized by "
+      "this program.");
+  }
+  if (reader.readPod<uint32_t>() != Globals::VERSION) {
+    throw std::runtime_error("Unsupported file version.");
+  }
+  timeOfIndexing         = reader.readPod<int64_t>();
+  const auto numSections = reader.readPod<uint32_t>();
+  if (numSections > MAX_NUM_SECTIONS) {
+    throw std::runtime_error("Corrupted index: too many sections");
+  }
+
+  const size_t tableSize   = numSections * SECTION_ENTRY_SIZE + sizeof(uint32_t);
+  const uint64_t dataStart = fixedSize + tableSize;
+  if (fileSize < dataStart) {
+    throw std::runtime_error("Corrupted index: section table truncated");
+  }
+  header.resize(fixedSize + tableSize);
+  if (!file.read(header.data() + fixedSize, static_cast<std::streamsize>(tableSize))) {
+    throw std::runtime_error("Corrupted index: section table truncated");
+  }
+  BinaryReader table(header.data() + fixedSize, tableSize);
+  sectionTable.resize(numSections);
+  for (auto& section : sectionTable) {
+    section.id       = static_cast<IndexSection>(table.readPod<uint32_t>());
+    section.offset   = table.readPod<uint64_t>();
+    section.size     = table.readPod<uint64_t>();
+    section.checksum = table.readPod<uint32_t>();
+  }
+  // the header checksum is always verified, it is small
+  const auto headerChecksum = table.readPod<uint32_t>();
+  if (crc32c(header.data(), header.size() - sizeof(uint32_t)) != headerChecksum) {
+    throw std::runtime_error("Corrupted index: header checksum mismatch");
+  }
+
+  // The sections must cover the rest of the file exactly, without overlapping.
+  // This also catches truncated files without reading them.
+  std::vector<SectionEntry> sorted = sectionTable;
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    return a.offset < b.offset;
+  });
+  uint64_t expectedOffset = dataStart;
+  for (const auto& section : sorted) {
+    if (section.offset != expectedOffset || section.size > fileSize - section.offset) {
+      throw std::runtime_error("Corrupted index: invalid section table");
+    }
+    expectedOffset += section.size;
+  }
+  if (expectedOffset != fileSize) {
+    throw std::runtime_error("Corrupted index: file size does not match the section table");
+  }
+  for (size_t i = 0; i < sectionTable.size(); ++i) {
+    for (size_t j = i + 1; j < sectionTable.size(); ++j) {
+      if (sectionTable[i].id == sectionTable[j].id) {
+        throw std::runtime_error("Corrupted index: duplicated section");
+      }
+    }
+  }
+}
+
+bool IndexFileReader::hasSection(const IndexSection id) const {
+  return std::any_of(sectionTable.begin(), sectionTable.end(), [id](const auto& section) {
+    return section.id == id;
+  });
+}
+
+const IndexFileReader::SectionEntry& IndexFileReader::findSection(const IndexSection id) const {
+  for (const auto& section : sectionTable) {
+    if (section.id == id) {
+      return section;
+    }
+  }
+  throw std::runtime_error("Corrupted index: missing section " +
+                           std::to_string(static_cast<uint32_t>(id)));
+}
+
+std::vector<char> IndexFileReader::readSection(const IndexSection id) {
+  const SectionEntry& section = findSection(id);
+  // the size was checked against the file size, the allocation is safe
+  std::vector<char> data(static_cast<size_t>(section.size));
+  file.seekg(static_cast<std::streamoff>(section.offset));
+  if (!file.read(data.data(), static_cast<std::streamsize>(data.size()))) {
+    throw std::runtime_error("Corrupted index: could not read section");
+  }
+  if (validation == IndexValidation::FULL &&
+      crc32c(data.data(), data.size()) != section.checksum) {
+    throw std::runtime_error("Corrupted index: checksum mismatch in section " +
+                             std::to_string(static_cast<uint32_t>(id)));
+  }
+  return data;
+}
+
+bool IndexFileReader::validate(const std::filesystem::path& filename,
+                               const IndexValidation validation,
+                               std::string* error) {
+  try {
+    IndexFileReader reader(filename, validation);
+    if (validation == IndexValidation::FULL) {
+      for (const auto& section : reader.sectionTable) {
+        reader.readSection(section.id);
+      }
+    }
+    return true;
+  } catch (const std::exception& e) {
+    if (error != nullptr) {
+      *error = e.what();
+    }
+    return false;
+  }
+}
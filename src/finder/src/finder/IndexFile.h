@@ -0,0 +1,100 @@
+#pragma once
+
+#include <finder/BinaryIO.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+/*!
+ * \brief The sections an index file can contain.
+ */
+enum class IndexSection : uint32_t {
+  PATH_TABLE = 1,
+  // optional, see MetadataColumns
+  METADATA = 2,
+};
+
+/*!
+ * \brief How much of an index file is checked before it is used.
+ * HEADER_ONLY checks identifier, version and the section table against the file
+ * size without reading the sections. FULL also verifies the checksum of every
+ * section read.
+ */
+enum class IndexValidation { HEADER_ONLY, FULL };
+
+/*!
+ * \brief Layout of an index file:
+ *
+ * identifier | version | time of indexing | number of sections |
+ * section table: (id, offset, size, crc32c) per section | crc32c of all before |
+ * sections
+ *
+ * The table is checked before anything else is read, so a truncated or garbage
+ * file is rejected without reading (or allocating) more than the header.
+ */
+class IndexFileWriter {
+ public:
+  /*!
+   * \brief Add a section, its content is taken from the writer.
+   */
+  void addSection(const IndexSection id, BinaryWriter&& section);
+
+  /*!
+   * \brief Write the file. Throws std::runtime_error on failure.
+   */
+  void write(const std::filesystem::path& filename, const int64_t timeOfIndexing) const;
+
+ private:
+  struct Section {
+    IndexSection id;
+    std::vector<char> data;
+  };
+  std::vector<Section> sections;
+};
+
+class IndexFileReader {
+ public:
+  /*!
+   * \brief Open the file, read and validate its header and section table.
+   * Throws std::runtime_error if the file is not a valid index file.
+   * \param validation With HEADER_ONLY the section checksums are not verified.
+   */
+  IndexFileReader(const std::filesystem::path& filename, const IndexValidation validation);
+
+  int64_t getTimeOfIndexing() const { return timeOfIndexing; }
+
+  bool hasSection(const IndexSection id) const;
+
+  /*!
+   * \brief Read the content of a section and verify its checksum (if validation is FULL).
+   * Throws std::runtime_error if the section is missing or corrupted.
+   */
+  std::vector<char> readSection(const IndexSection id);
+
+  /*!
+   * \brief Check if the file is a valid index file without using it.
+   * \return false if not, the reason is written into error if given.
+   */
+  static bool validate(const std::filesystem::path& filename,
+                       const IndexValidation validation,
+                       std::string* error = nullptr);
+
+  // limits which keep a garbage header from causing huge allocations
+  static constexpr uint32_t MAX_NUM_SECTIONS = 64;
+
+ private:
+  struct SectionEntry {
+    IndexSection id;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t checksum;
+  };
+  const SectionEntry& findSection(const IndexSection id) const;
+
+  std::ifstream file;
+  IndexValidation validation;
+  int64_t timeOfIndexing = 0;
+  std::vector<SectionEntry> sectionTable;
+};
@@ -0,0 +1,59 @@
+#include <finder/IndexStatistics.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+void printHistogram(std::ostringstream& out, const std::vector<size_t>& histogram) {
+  bool first = true;
+  for (size_t i = 0; i < histogram.size(); ++i) {
+    if (histogram[i] == 0) {
+      continue;
+    }
+    const bool isLast = i + 1 == IndexStatistics::MAX_HISTOGRAM_SIZE;
+    out << (first ? " " : ", ") << i << (isLast ? "+" : "") << ": " << histogram[i];
+    first = false;
+  }
+  out << '\n';
+}
+
+void printBytes(std::ostringstream& out,
+                const char* category,
+                const size_t bytes,
+                const size_t entries) {
+  out << "  " << std::left << std::setw(14) << category << std::right << std::setw(10)
+      << bytes / 1024 << " KB" << std::setw(8) << (entries == 0 ? 0. : double(bytes) / entries)
+      << " B/entry\n";
+}
+}  // namespace
+
+void IndexStatistics::add(std::vector<size_t>& histogram, const size_t value) {
+  const size_t bucket = std::min(value, MAX_HISTOGRAM_SIZE - 1);
+  if (histogram.size() <= bucket) {
+    histogram.resize(bucket + 1, 0);
+  }
+  ++histogram[bucket];
+}
+
+std::string IndexStatistics::toString() const {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(1);
+  out << "entries: " << numEntries << " (" << numPathEntries << " in the path table, "
+      << numNames << " distinct names, " << numExtensions << " extensions)\n";
+  out << "trie nodes: " << numNodes << " (" << numLeaves << " with entries)\n";
+  out << "memory: " << bytes.getTotal() / 1024 << " KB, " << getBytesPerEntry()
+      << " bytes/entry\n";
+  printBytes(out, "nodes", bytes.nodes, numEntries);
+  printBytes(out, "child maps", bytes.childMaps, numEntries);
+  printBytes(out, "entry vectors", bytes.entryVectors, numEntries);
+  printBytes(out, "names", bytes.names, numEntries);
+  printBytes(out, "path table", bytes.pathTable, numEntries);
+  printBytes(out, "extensions", bytes.extensionIndex, numEntries);
+  printBytes(out, "metadata", bytes.metadata, numEntries);
+  out << "fan-out:";
+  printHistogram(out, fanOut);
+  out << "single child chains:";
+  printHistogram(out, chainLength);
+  return out.str();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief What an index holds and what it costs, see Dictionary::getStatistics().
+ *
+ * Bytes are the heap memory of the containers (capacity, buckets and nodes of the
+ * maps), without the overhead of the allocator.
+ */
+struct IndexStatistics {
+  // histograms: larger values are counted in the last bucket
+  static constexpr size_t MAX_HISTOGRAM_SIZE = 32;
+
+  // searchable entries
+  size_t numEntries = 0;
+  // entries of the path table, including the base entries of not indexed parents
+  size_t numPathEntries = 0;
+  size_t numNames       = 0;
+  // distinct extensions of the files
+  size_t numExtensions = 0;
+
+  size_t numNodes = 0;
+  // nodes where at least one name ends
+  size_t numLeaves = 0;
+  // fanOut[i]: nodes with i children
+  std::vector<size_t> fanOut;
+  // chainLength[i]: runs of i nodes with one child and no entries, a radix tree
+  // would store each run as one node
+  std::vector<size_t> chainLength;
+
+  struct Bytes {
+    size_t nodes        = 0;
+    size_t childMaps    = 0;
+    size_t entryVectors = 0;
+    // the compressed names of the StringPool
+    size_t names = 0;
+    // parents, name ids and directory flags of the PathTable
+    size_t pathTable = 0;
+    // the bitmaps of the ExtensionIndex
+    size_t extensionIndex = 0;
+    // the size and time columns, see MetadataColumns
+    size_t metadata = 0;
+
+    size_t getTotal() const {
+      return nodes + childMaps + entryVectors + names + pathTable + extensionIndex + metadata;
+    }
+  } bytes;
+
+  double getBytesPerEntry() const {
+    return numEntries == 0 ? 0. : static_cast<double>(bytes.getTotal()) / numEntries;
+  }
+
+  /*!
+   * \brief Count a value into a histogram.
+   */
+  static void add(std::vector<size_t>& histogram, const size_t value);
+
+  /*!
+   * \brief A multi line report of everything above.
+   */
+  std::string toString() const;
+};
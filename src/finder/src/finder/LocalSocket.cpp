@@ -0,0 +1,204 @@
+#include <finder/LocalSocket.h>
+
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+LocalSocket::LocalSocket(LocalSocket&& other) noexcept
+    : fd(other.fd),
+      boundPath(std::move(other.boundPath)) {
+  other.fd = -1;
+  other.boundPath.clear();
+}
+
+LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept {
+  if (this != &other) {
+    close();
+    fd        = other.fd;
+    boundPath = std::move(other.boundPath);
+    other.fd  = -1;
+    other.boundPath.clear();
+  }
+  return *this;
+}
+
+LocalSocket::~LocalSocket() { close(); }
+
+#ifdef _WIN32
+
+LocalSocket LocalSocket::listen(const std::filesystem::path&) {
+  throw std::runtime_error("Local sockets are not supported on windows");
+}
+
+LocalSocket LocalSocket::connect(const std::filesystem::path&) {
+  throw std::runtime_error("Local sockets are not supported on windows");
+}
+
+LocalSocket LocalSocket::accept(const int) { return LocalSocket(); }
+
+void LocalSocket::shutdown() {}
+
+void LocalSocket::close() { fd = -1; }
+
+bool LocalSocket::sendAll(const char*, size_t) { return false; }
+
+bool LocalSocket::receiveAll(char*, size_t) { return false; }
+
+#else
+
+namespace {
+sockaddr_un makeAddress(const std::filesystem::path& path) {
+  sockaddr_un address{};
+  address.sun_family     = AF_UNIX;
+  const std::string name = path.string();
+  if (name.size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("Socket path too long: " + name);
+  }
+  std::memcpy(address.sun_path, name.c_str(), name.size() + 1);
+  return address;
+}
+
+int createSocket() {
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    throw std::runtime_error(std::string("Could not create socket: ") + std::strerror(errno));
+  }
+#ifdef SO_NOSIGPIPE
+  // no MSG_NOSIGNAL on macOS, a closed peer must not kill us
+  const int noSigPipe = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+  return fd;
+}
+}  // namespace
+
+LocalSocket LocalSocket::listen(const std::filesystem::path& path) {
+  const sockaddr_un address = makeAddress(path);
+  LocalSocket socket(createSocket());
+
+  // a daemon which did not shut down cleanly leaves its socket file behind
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+
+  if (::bind(socket.fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    throw std::runtime_error("Could not bind " + path.string() + ": " + std::strerror(errno));
+  }
+  socket.boundPath = path;
+  // only the owner may query the indexed files
+  std::filesystem::permissions(path, std::filesystem::perms::owner_read |
+                                       std::filesystem::perms::owner_write, ec);
+  if (::listen(socket.fd, SOMAXCONN) != 0) {
+    throw std::runtime_error("Could not listen on " + path.string() + ": " +
+                             std::strerror(errno));
+  }
+  return socket;
+}
+
+LocalSocket LocalSocket::connect(const std::filesystem::path& path) {
+  const sockaddr_un address = makeAddress(path);
+  LocalSocket socket(createSocket());
+  if (::connect(socket.fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    throw std::runtime_error("Could not connect to " + path.string() + ": " +
+                             std::strerror(errno));
+  }
+  return socket;
+}
+
+LocalSocket LocalSocket::accept(const int timeout_ms) {
+  pollfd request{fd, POLLIN, 0};
+  if (::poll(&request, 1, timeout_ms) <= 0 || (request.revents & POLLIN) == 0) {
+    return LocalSocket();
+  }
+  const int client = ::accept(fd, nullptr, nullptr);
+  return client < 0 ? LocalSocket() : LocalSocket(client);
+}
+
+void LocalSocket::shutdown() {
+  if (fd >= 0) {
+    ::shutdown(fd, SHUT_RDWR);
+  }
+}
+
+void LocalSocket::close() {
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+  if (!boundPath.empty()) {
+    std::error_code ec;
+    std::filesystem::remove(boundPath, ec);
+    boundPath.clear();
+  }
+}
+
+bool LocalSocket::sendAll(const char* data, size_t size) {
+#ifdef MSG_NOSIGNAL
+  constexpr int FLAGS = MSG_NOSIGNAL;
+#else
+  constexpr int FLAGS = 0;
+#endif
+  while (size > 0) {
+    const ssize_t sent = ::send(fd, data, size, FLAGS);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    data += sent;
+    size -= static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+bool LocalSocket::receiveAll(char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t received = ::recv(fd, data, size, 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    data += received;
+    size -= static_cast<size_t>(received);
+  }
+  return true;
+}
+
+#endif
+
+bool LocalSocket::send(const BinaryWriter& message) {
+  if (!isValid() || message.size() > MAX_MESSAGE_SIZE) {
+    return false;
+  }
+  BinaryWriter header;
+  header.writePod(static_cast<uint32_t>(message.size()));
+  return sendAll(header.getBuffer().data(), header.size()) &&
+         sendAll(message.getBuffer().data(), message.size());
+}
+
+bool LocalSocket::receive(std::vector<char>& message) {
+  if (!isValid()) {
+    return false;
+  }
+  char header[sizeof(uint32_t)];
+  if (!receiveAll(header, sizeof(header))) {
+    return false;
+  }
+  const auto size = BinaryReader(header, sizeof(header)).readPod<uint32_t>();
+  if (size > MAX_MESSAGE_SIZE) {
+    return false;
+  }
+  message.resize(size);
+  return receiveAll(message.data(), size);
+}
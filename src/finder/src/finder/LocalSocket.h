@@ -0,0 +1,68 @@
+#pragma once
+
+#include <finder/BinaryIO.h>
+
+#include <filesystem>
+#include <vector>
+
+/*!
+ * \brief A unix domain socket exchanging whole messages.
+ *
+ * Every message is sent as its length (uint32, little endian) followed by the bytes.
+ * listen() and connect() throw std::runtime_error on failure, send() and receive()
+ * return false once the connection is gone. Not available on windows, listen() and
+ * connect() always throw there.
+ */
+class LocalSocket {
+ public:
+  // larger messages are treated as a broken connection
+  static constexpr uint32_t MAX_MESSAGE_SIZE = 256u << 20;
+
+  LocalSocket() = default;
+  LocalSocket(const LocalSocket&)            = delete;
+  LocalSocket& operator=(const LocalSocket&) = delete;
+  LocalSocket(LocalSocket&& other) noexcept;
+  LocalSocket& operator=(LocalSocket&& other) noexcept;
+  ~LocalSocket();
+
+  /*!
+   * \brief Create the socket file and listen on it. A stale socket file is replaced.
+   */
+  static LocalSocket listen(const std::filesystem::path& path);
+
+  static LocalSocket connect(const std::filesystem::path& path);
+
+  /*!
+   * \brief Wait up to timeout_ms for a client of a listening socket.
+   * \return An invalid socket if no client connected meanwhile.
+   */
+  LocalSocket accept(const int timeout_ms);
+
+  bool isValid() const { return fd >= 0; }
+
+  bool send(const BinaryWriter& message);
+
+  /*!
+   * \brief Block until a complete message arrived.
+   * \return false if the peer closed the connection or sent garbage.
+   */
+  bool receive(std::vector<char>& message);
+
+  /*!
+   * \brief Stop all transfers, a receive() blocked in another thread returns false.
+   */
+  void shutdown();
+
+  void close();
+
+ private:
+  explicit LocalSocket(const int fd)
+      : fd(fd) {}
+
+  bool sendAll(const char* data, size_t size);
+  bool receiveAll(char* data, size_t size);
+
+  int fd = -1;
+  // the socket file of a listening socket, removed on close
+  std::filesystem::path boundPath;
+};
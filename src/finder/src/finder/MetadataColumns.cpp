@@ -0,0 +1,60 @@
+#include <finder/MetadataColumns.h>
+
+#include <stdexcept>
+
+namespace {
+// small negative and positive differences both become small varints
+uint64_t zigzag(const int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(const uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+}  // namespace
+
+void MetadataColumns::set(const EntryId id, const EntryMetadata& metadata) {
+  if (sizes.size() <= id) {
+    sizes.resize(id + 1, 0);
+    modificationTimes.resize(id + 1, EntryMetadata::UNKNOWN_TIME);
+  }
+  sizes[id]             = metadata.size;
+  modificationTimes[id] = metadata.modificationTime;
+}
+
+void MetadataColumns::serialize(BinaryWriter& writer) const {
+  writer.writeVarint(sizes.size());
+  for (const uint64_t size : sizes) {
+    writer.writeVarint(size);
+  }
+  // the entries of a folder are added together and often changed together, so the
+  // times are stored as the difference to the previous entry
+  int64_t previous = 0;
+  for (const int64_t time : modificationTimes) {
+    writer.writeVarint(zigzag(static_cast<int64_t>(static_cast<uint64_t>(time) -
+                                                   static_cast<uint64_t>(previous))));
+    previous = time;
+  }
+}
+
+void MetadataColumns::deserialize(BinaryReader& reader, const size_t numEntries) {
+  // a varint for the size and one for the time
+  constexpr size_t MIN_BYTES_PER_ENTRY = 2;
+  const size_t count                   = reader.readCount(MIN_BYTES_PER_ENTRY);
+  if (count > numEntries) {
+    throw std::runtime_error("Corrupted index: more metadata than entries");
+  }
+  std::vector<uint64_t> newSizes(count);
+  std::vector<int64_t> newTimes(count);
+  for (uint64_t& size : newSizes) {
+    size = reader.readVarint();
+  }
+  int64_t previous = 0;
+  for (int64_t& time : newTimes) {
+    time     = static_cast<int64_t>(static_cast<uint64_t>(previous) +
+                                static_cast<uint64_t>(unzigzag(reader.readVarint())));
+    previous = time;
+  }
+  sizes             = std::move(newSizes);
+  modificationTimes = std::move(newTimes);
+}
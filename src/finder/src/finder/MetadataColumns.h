@@ -0,0 +1,84 @@
+#pragma once
+
+#include <finder/BinaryIO.h>
+#include <finder/EntryId.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*!
+ * \brief What the crawl found out about an entry besides its path.
+ */
+struct EntryMetadata {
+  static constexpr int64_t UNKNOWN_TIME = std::numeric_limits<int64_t>::min();
+
+  // bytes, 0 for folders
+  uint64_t size = 0;
+  // seconds since the epoch
+  int64_t modificationTime = UNKNOWN_TIME;
+};
+
+/*!
+ * \brief Ranges an entry's metadata has to be in. Folders have no size, a size range
+ * only lets files pass.
+ */
+struct MetadataFilter {
+  uint64_t minSize            = 0;
+  uint64_t maxSize            = std::numeric_limits<uint64_t>::max();
+  int64_t minModificationTime = std::numeric_limits<int64_t>::min();
+  int64_t maxModificationTime = std::numeric_limits<int64_t>::max();
+
+  bool filtersSize() const {
+    return minSize != 0 || maxSize != std::numeric_limits<uint64_t>::max();
+  }
+  bool filtersModificationTime() const {
+    return minModificationTime != std::numeric_limits<int64_t>::min() ||
+           maxModificationTime != std::numeric_limits<int64_t>::max();
+  }
+  bool isActive() const { return filtersSize() || filtersModificationTime(); }
+
+  bool accepts(const EntryMetadata& metadata, const bool isDirectory) const {
+    if (filtersSize() && (isDirectory || metadata.size < minSize || metadata.size > maxSize)) {
+      return false;
+    }
+    // an unknown time is in no range
+    return !filtersModificationTime() ||
+           (metadata.modificationTime != EntryMetadata::UNKNOWN_TIME &&
+            metadata.modificationTime >= minModificationTime &&
+            metadata.modificationTime <= maxModificationTime);
+  }
+};
+
+/*!
+ * \brief Size and modification time of the entries, one column each, indexed by entry id.
+ *
+ * The columns are optional: an index crawled without metadata, or loaded from a file
+ * written before there was any, has none. Entries without metadata (e.g. the base
+ * entries of the PathTable) get EntryMetadata().
+ */
+class MetadataColumns {
+ public:
+  void set(const EntryId id, const EntryMetadata& metadata);
+
+  EntryMetadata get(const EntryId id) const {
+    return id < sizes.size() ? EntryMetadata{sizes[id], modificationTimes[id]} : EntryMetadata();
+  }
+
+  bool empty() const { return sizes.empty(); }
+
+  size_t getMemoryUsage() const {
+    return sizes.capacity() * sizeof(uint64_t) + modificationTimes.capacity() * sizeof(int64_t);
+  }
+
+  void serialize(BinaryWriter& writer) const;
+  /*!
+   * \brief Read the columns of numEntries entries.
+   */
+  void deserialize(BinaryReader& reader, const size_t numEntries);
+
+ private:
+  std::vector<uint64_t> sizes;
+  std::vector<int64_t> modificationTimes;
+};
@@ -31,6 +31,14 @@ wchar_t Needle::getCurrentLetter() const {
   return (*_search_string)[currentIndex];
 }
 
+wchar_t Needle::getLetter(const size_t index) const { return (*_search_string)[index]; }
+
+bool Needle::isWildCard(const size_t index) const {
+  return _use_wildcard && (*_search_string)[index] == _wildcard;
+}
+
+size_t Needle::getNumFuzzyChanges() const { return _num_fuzzy_changes; }
+
 void Needle::nextIndex() {
   ++currentIndex;
   assert(currentIndex < _search_string->size() + 1);
@@ -32,6 +32,11 @@ class Needle {
 
   wchar_t getCurrentLetter() const;
 
+  // by position, for searches which track the index themselves
+  wchar_t getLetter(const size_t index) const;
+  bool isWildCard(const size_t index) const;
+  size_t getNumFuzzyChanges() const;
+
   void nextIndex();
   void undo_nextIndex();
 
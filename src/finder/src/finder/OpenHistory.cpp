@@ -0,0 +1,95 @@
+#include <finder/OpenHistory.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+uint64_t OpenHistory::hash(const std::wstring& str) {
+  constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+  constexpr uint64_t FNV_PRIME        = 1099511628211ULL;
+  uint64_t hash                       = FNV_OFFSET_BASIS;
+  for (const wchar_t c : str) {
+    hash ^= static_cast<uint64_t>(c);
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+double OpenHistory::Record::getOpens(const int64_t now) const {
+  constexpr double SECONDS_PER_DAY = 24. * 3600.;
+  // a clock set back does not make opens grow
+  const double days = std::max<double>(0., static_cast<double>(now - lastOpened) / SECONDS_PER_DAY);
+  return opens * std::exp2(-days / HALF_LIFE_DAYS);
+}
+
+void OpenHistory::recordOpen(const std::filesystem::path& path, const int64_t now) {
+  const uint64_t pathHash = hash(path.wstring());
+  auto record             = records.find(pathHash);
+  if (record == records.end()) {
+    if (records.size() >= MAX_RECORDS) {
+      erase(std::min_element(records.begin(), records.end(), [now](const auto& a, const auto& b) {
+        return a.second.getOpens(now) < b.second.getOpens(now);
+      }));
+    }
+    record                  = records.emplace(pathHash, Record()).first;
+    record->second.nameHash = hash(path.filename().wstring());
+    ++nameCounts[record->second.nameHash];
+  }
+  record->second.opens      = record->second.getOpens(now) + 1.;
+  record->second.lastOpened = now;
+}
+
+double OpenHistory::getMaxOpens(const int64_t now) const {
+  double maxOpens = 0.;
+  for (const auto& [pathHash, record] : records) {
+    maxOpens = std::max(maxOpens, record.getOpens(now));
+  }
+  return maxOpens;
+}
+
+void OpenHistory::erase(const std::unordered_map<uint64_t, Record>::iterator record) {
+  const auto names = nameCounts.find(record->second.nameHash);
+  if (names != nameCounts.end() && --names->second == 0) {
+    nameCounts.erase(names);
+  }
+  records.erase(record);
+}
+
+void OpenHistory::serialize(BinaryWriter& writer) const {
+  writer.writePod(FORMAT_VERSION);
+  writer.writeVarint(records.size());
+  for (const auto& [pathHash, record] : records) {
+    writer.writePod(pathHash);
+    writer.writePod(record.nameHash);
+    writer.writePod(record.opens);
+    writer.writePod(record.lastOpened);
+  }
+}
+
+void OpenHistory::deserialize(BinaryReader& reader) {
+  if (reader.readPod<uint32_t>() != FORMAT_VERSION) {
+    throw std::runtime_error("Unsupported open history version");
+  }
+  constexpr size_t BYTES_PER_RECORD = 2 * sizeof(uint64_t) + sizeof(double) + sizeof(int64_t);
+  const size_t count                = reader.readCount(BYTES_PER_RECORD);
+  if (count > MAX_RECORDS) {
+    throw std::runtime_error("Corrupted open history: too many records");
+  }
+  std::unordered_map<uint64_t, Record> newRecords;
+  std::unordered_map<uint64_t, uint32_t> newNameCounts;
+  for (size_t i = 0; i < count; ++i) {
+    const auto pathHash = reader.readPod<uint64_t>();
+    Record record;
+    record.nameHash   = reader.readPod<uint64_t>();
+    record.opens      = reader.readPod<double>();
+    record.lastOpened = reader.readPod<int64_t>();
+    if (!std::isfinite(record.opens) || record.opens < 0.) {
+      throw std::runtime_error("Corrupted open history: invalid count");
+    }
+    if (newRecords.emplace(pathHash, record).second) {
+      ++newNameCounts[record.nameHash];
+    }
+  }
+  records    = std::move(newRecords);
+  nameCounts = std::move(newNameCounts);
+}
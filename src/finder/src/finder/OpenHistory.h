@@ -0,0 +1,77 @@
+#pragma once
+
+#include <finder/BinaryIO.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+/*!
+ * \brief How often and how recently the user opened which results, to rank them higher.
+ *
+ * Every open counts one, halving every HALF_LIFE_DAYS. Entry ids change with every
+ * crawl, so the records are keyed by a hash of the full path. A second hash of only the
+ * name is checked first: a result whose name was never opened costs one lookup, its
+ * path is not assembled.
+ */
+class OpenHistory {
+ public:
+  static constexpr size_t MAX_RECORDS      = 1024;
+  static constexpr double HALF_LIFE_DAYS   = 14.;
+  static constexpr uint32_t FORMAT_VERSION = 1;
+
+  /*!
+   * \brief Count an open of the path. With MAX_RECORDS the least opened one is dropped.
+   * \param now Seconds since the epoch.
+   */
+  void recordOpen(const std::filesystem::path& path, const int64_t now);
+
+  /*!
+   * \brief The decayed opens of an entry, 0 if it was never opened.
+   * \param getPath Called for the full path only if a file of this name was opened.
+   */
+  template <typename GetPath>
+  double getOpens(const std::wstring& name, GetPath&& getPath, const int64_t now) const {
+    if (nameCounts.find(hash(name)) == nameCounts.end()) {
+      return 0.;
+    }
+    const auto record = records.find(hash(getPath().wstring()));
+    return record == records.end() ? 0. : record->second.getOpens(now);
+  }
+
+  /*!
+   * \brief The decayed opens of the most opened entry, 0 if there is none.
+   */
+  double getMaxOpens(const int64_t now) const;
+
+  bool empty() const { return records.empty(); }
+  size_t size() const { return records.size(); }
+
+  void serialize(BinaryWriter& writer) const;
+  /*!
+   * \brief Throws std::runtime_error on a corrupted or unknown history.
+   */
+  void deserialize(BinaryReader& reader);
+
+  // FNV-1a: stable over program runs and platforms, unlike std::hash
+  static uint64_t hash(const std::wstring& str);
+
+ private:
+  struct Record {
+    uint64_t nameHash = 0;
+    // the opens at lastOpened
+    double opens       = 0.;
+    int64_t lastOpened = 0;
+
+    double getOpens(const int64_t now) const;
+  };
+
+  void erase(const std::unordered_map<uint64_t, Record>::iterator record);
+
+  // path hash -> record
+  std::unordered_map<uint64_t, Record> records;
+  // name hash -> number of records of that name
+  std::unordered_map<uint64_t, uint32_t> nameCounts;
+};
@@ -0,0 +1,117 @@
+#include <finder/PathTable.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+EntryId PathTable::addEntry(const EntryId parent,
+                            const std::wstring& name,
+                            const bool isDirectory) {
+  const auto id = static_cast<EntryId>(parents.size());
+  if (id == NO_ENTRY) {
+    throw std::length_error("PathTable: too many entries");
+  }
+  parents.push_back(parent);
+  nameIds.push_back(names.add(name));
+  directories.push_back(isDirectory ? 1 : 0);
+  return id;
+}
+
+EntryId PathTable::add(const std::filesystem::path& path, const bool isDirectory) {
+  const std::wstring parentPath = path.parent_path().wstring();
+  EntryId parent;
+  const auto it = directoryIds.find(parentPath);
+  if (it != directoryIds.end()) {
+    parent = it->second;
+  } else {
+    parent = addEntry(NO_ENTRY, parentPath, true);
+    directoryIds.emplace(parentPath, parent);
+  }
+
+  const EntryId id = addEntry(parent, path.filename().wstring(), isDirectory);
+  if (isDirectory) {
+    directoryIds.emplace(path.wstring(), id);
+  }
+  return id;
+}
+
+void PathTable::finalize(const bool useEntropyCoder) {
+  const std::vector<StringPool::StringId> newIds = names.finalize(useEntropyCoder);
+  for (auto& nameId : nameIds) {
+    nameId = newIds[nameId];
+  }
+  directoryIds.clear();
+  indexChildren();
+}
+
+void PathTable::indexChildren() {
+  // a counting sort of the entries by parent
+  childOffsets.assign(parents.size() + 1, 0);
+  for (const EntryId parent : parents) {
+    if (parent != NO_ENTRY) {
+      ++childOffsets[parent + 1];
+    }
+  }
+  for (size_t i = 1; i < childOffsets.size(); ++i) {
+    childOffsets[i] += childOffsets[i - 1];
+  }
+  childIds.resize(childOffsets.back());
+  std::vector<uint32_t> next(childOffsets.begin(), childOffsets.end() - 1);
+  for (EntryId id = 0; id < parents.size(); ++id) {
+    if (parents[id] != NO_ENTRY) {
+      childIds[next[parents[id]]++] = id;
+    }
+  }
+}
+
+std::wstring PathTable::getName(const EntryId id) const { return names.get(nameIds[id]); }
+
+std::filesystem::path PathTable::getPath(const EntryId id) const {
+  std::vector<EntryId> chain;
+  for (EntryId current = id; current != NO_ENTRY; current = parents[current]) {
+    chain.push_back(current);
+  }
+  std::filesystem::path path;
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    path /= getName(*it);
+  }
+  return path;
+}
+
+void PathTable::serialize(BinaryWriter& writer) const {
+  names.serialize(writer);
+  writer.writeVarint(parents.size());
+  for (size_t id = 0; id < parents.size(); ++id) {
+    // parents are added first, so the distance to the parent is positive and usually small
+    writer.writeVarint(parents[id] == NO_ENTRY ? 0 : id - parents[id]);
+    writer.writeVarint(static_cast<uint64_t>(nameIds[id]) << 1 | directories[id]);
+  }
+}
+
+void PathTable::deserialize(BinaryReader& reader) {
+  directoryIds.clear();
+  names.deserialize(reader);
+
+  constexpr size_t MIN_BYTES_PER_ENTRY = 2;
+  const size_t numEntries              = reader.readCount(MIN_BYTES_PER_ENTRY);
+  if (numEntries >= NO_ENTRY) {
+    throw std::runtime_error("Corrupted index: too many entries");
+  }
+  parents.resize(numEntries);
+  nameIds.resize(numEntries);
+  directories.resize(numEntries);
+  for (size_t id = 0; id < numEntries; ++id) {
+    const uint64_t parentDistance = reader.readVarint();
+    if (parentDistance > id) {
+      throw std::runtime_error("Corrupted index: invalid parent entry");
+    }
+    parents[id] = parentDistance == 0 ? NO_ENTRY : static_cast<EntryId>(id - parentDistance);
+
+    const uint64_t name = reader.readVarint();
+    if ((name >> 1) >= names.size()) {
+      throw std::runtime_error("Corrupted index: invalid name");
+    }
+    nameIds[id]     = static_cast<StringPool::StringId>(name >> 1);
+    directories[id] = static_cast<uint8_t>(name & 1);
+  }
+  indexChildren();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <finder/BinaryIO.h>
+#include <finder/EntryId.h>
+#include <finder/StringPool.h>
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * \brief All indexed files and folders, each one stored as its parent plus its name.
+ *
+ * A full path is only assembled when it is needed (e.g. to show a result), by
+ * walking up the parents. The names live in a StringPool, so a folder name is
+ * stored once no matter how many entries it contains.
+ * Entries whose parent was not indexed (e.g. the children of the root folder)
+ * get a hidden base entry which holds the complete parent path as its name.
+ */
+class PathTable {
+ public:
+  /*!
+   * \brief Add an entry while building. Its parent folder must have been added
+   * before, otherwise a base entry for the parent is created.
+   */
+  EntryId add(const std::filesystem::path& path, const bool isDirectory);
+
+  /*!
+   * \brief Compress the names. Entry ids stay the same.
+   */
+  void finalize(const bool useEntropyCoder);
+
+  std::filesystem::path getPath(const EntryId id) const;
+  std::wstring getName(const EntryId id) const;
+  StringPool::StringId getNameId(const EntryId id) const { return nameIds[id]; }
+  EntryId getParent(const EntryId id) const { return parents[id]; }
+  // base entries only hold the path of not indexed parents, they are no results
+  bool isBase(const EntryId id) const { return parents[id] == NO_ENTRY; }
+  bool isDirectory(const EntryId id) const { return directories[id] != 0; }
+
+  /*!
+   * \brief Call f(child) for every entry directly inside the folder, in id order.
+   * The children are indexed by finalize() and deserialize(), none are found before.
+   */
+  template <typename F>
+  void forEachChild(const EntryId folder, F&& f) const {
+    if (static_cast<size_t>(folder) + 1 >= childOffsets.size()) {
+      return;
+    }
+    for (uint32_t i = childOffsets[folder]; i < childOffsets[folder + 1]; ++i) {
+      f(childIds[i]);
+    }
+  }
+
+  /*!
+   * \brief Number of entries including the base entries.
+   */
+  size_t size() const { return parents.size(); }
+
+  const StringPool& getNames() const { return names; }
+
+  /*!
+   * \brief Heap bytes of the parents, name ids and flags, the names not included.
+   */
+  size_t getMemoryUsage() const {
+    return parents.capacity() * sizeof(EntryId) +
+           nameIds.capacity() * sizeof(StringPool::StringId) + directories.capacity() +
+           childOffsets.capacity() * sizeof(uint32_t) + childIds.capacity() * sizeof(EntryId);
+  }
+
+  void serialize(BinaryWriter& writer) const;
+  void deserialize(BinaryReader& reader);
+
+ private:
+  EntryId addEntry(const EntryId parent, const std::wstring& name, const bool isDirectory);
+  void indexChildren();
+
+  StringPool names;
+  std::vector<EntryId> parents;
+  std::vector<StringPool::StringId> nameIds;
+  std::vector<uint8_t> directories;
+  // Derived from the parents, not stored: the children of entry i are childIds from
+  // childOffsets[i] to childOffsets[i + 1].
+  std::vector<uint32_t> childOffsets;
+  std::vector<EntryId> childIds;
+
+  // building: folder path -> entry, to find the parent of the next entries
+  std::unordered_map<std::wstring, EntryId> directoryIds;
+};
@@ -0,0 +1,184 @@
+#include <finder/Query.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cwctype>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <utility>
+
+namespace {
+bool isSeparator(const wchar_t c) {
+#ifdef _WIN32
+  return c == L'/' || c == L'\\';
+#else
+  return c == L'/';
+#endif
+}
+
+/*!
+ * \brief The extensions of a filter term "ext:a,b" or "*.a", false for other terms.
+ */
+bool parseExtensionFilter(const std::wstring& word, std::vector<std::wstring>& extensions) {
+  static const std::wstring FILTER_PREFIX = L"ext:";
+  static const std::wstring GLOB_PREFIX   = L"*.";
+  std::wstring list;
+  if (word.compare(0, FILTER_PREFIX.size(), FILTER_PREFIX) == 0) {
+    list = word.substr(FILTER_PREFIX.size());
+  } else if (word.size() > GLOB_PREFIX.size() &&
+             word.compare(0, GLOB_PREFIX.size(), GLOB_PREFIX) == 0 &&
+             word.find_first_of(L"*/\\,", GLOB_PREFIX.size()) == std::wstring::npos) {
+    list = word.substr(GLOB_PREFIX.size());
+  } else {
+    return false;
+  }
+  std::wistringstream items(list);
+  std::wstring extension;
+  while (std::getline(items, extension, L',')) {
+    if (!extension.empty() && extension[0] == L'.') {
+      extension.erase(0, 1);
+    }
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (!extension.empty()) {
+      extensions.push_back(extension);
+    }
+  }
+  return true;
+}
+
+/*!
+ * \brief A number with an optional unit, e.g. "100m". The units are lower case
+ * letters, a trailing 'b' ("100mb") is ignored.
+ */
+std::optional<uint64_t> parseQuantity(std::wstring text,
+                                      const std::vector<std::pair<wchar_t, uint64_t>>& units,
+                                      const uint64_t defaultUnit) {
+  std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+  if (text.size() > 2 && text.back() == L'b') {
+    text.pop_back();
+  }
+  uint64_t unit = defaultUnit;
+  if (!text.empty() && !std::iswdigit(text.back()) && text.back() != L'.') {
+    const auto known = std::find_if(
+      units.begin(), units.end(), [&text](const auto& u) { return u.first == text.back(); });
+    if (known == units.end()) {
+      return std::nullopt;
+    }
+    unit = known->second;
+    text.pop_back();
+  }
+  try {
+    size_t parsed        = 0;
+    const double number  = std::stod(text, &parsed);
+    const double maximum = static_cast<double>(std::numeric_limits<int64_t>::max());
+    if (parsed != text.size() || number < 0 || number * static_cast<double>(unit) >= maximum) {
+      return std::nullopt;
+    }
+    return static_cast<uint64_t>(number * static_cast<double>(unit));
+  } catch (const std::exception&) {
+    return std::nullopt;
+  }
+}
+
+/*!
+ * \brief Apply a filter term "size:>100m" or "modified:<7d", false for other terms or
+ * values which do not parse.
+ */
+bool parseMetadataFilter(const std::wstring& word, MetadataFilter& filter) {
+  static const std::wstring SIZE_PREFIX     = L"size:";
+  static const std::wstring MODIFIED_PREFIX = L"modified:";
+  const bool isSize     = word.compare(0, SIZE_PREFIX.size(), SIZE_PREFIX) == 0;
+  const bool isModified = word.compare(0, MODIFIED_PREFIX.size(), MODIFIED_PREFIX) == 0;
+  const size_t start    = isSize ? SIZE_PREFIX.size() : MODIFIED_PREFIX.size();
+  if ((!isSize && !isModified) || word.size() < start + 2 ||
+      (word[start] != L'<' && word[start] != L'>')) {
+    return false;
+  }
+  const bool isLess = word[start] == L'<';
+  // "<=" and ">=" are the same, the values are not that exact
+  const size_t valueStart = start + (word[start + 1] == L'=' ? 2 : 1);
+
+  if (isSize) {
+    constexpr uint64_t KIB = 1024;
+    const std::vector<std::pair<wchar_t, uint64_t>> units = {
+      {L'k', KIB}, {L'm', KIB * KIB}, {L'g', KIB * KIB * KIB}, {L't', KIB * KIB * KIB * KIB}};
+    const auto size = parseQuantity(word.substr(valueStart), units, 1);
+    if (!size) {
+      return false;
+    }
+    (isLess ? filter.maxSize : filter.minSize) = *size;
+    return true;
+  }
+
+  constexpr uint64_t HOUR = 3600;
+  constexpr uint64_t DAY  = 24 * HOUR;
+  const std::vector<std::pair<wchar_t, uint64_t>> units = {
+    {L'h', HOUR}, {L'd', DAY}, {L'w', 7 * DAY}, {L'y', 365 * DAY}};
+  // without a unit: days
+  const auto age = parseQuantity(word.substr(valueStart), units, DAY);
+  if (!age) {
+    return false;
+  }
+  const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+  // changed less than the age ago: after now - age
+  (isLess ? filter.minModificationTime : filter.maxModificationTime) =
+    now - static_cast<int64_t>(*age);
+  return true;
+}
+
+/*!
+ * \brief The key of a term "sort:size" or "sort:modified", false for other terms.
+ */
+bool parseSortKey(const std::wstring& word, Query::SortKey& sortKey) {
+  if (word == L"sort:size") {
+    sortKey = Query::SortKey::SIZE;
+  } else if (word == L"sort:modified") {
+    sortKey = Query::SortKey::MODIFICATION_TIME;
+  } else if (word == L"sort:score") {
+    sortKey = Query::SortKey::SCORE;
+  } else {
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
+Query Query::parse(const std::wstring& text,
+                   const std::function<size_t(size_t)>& getFuzzyReplacements) {
+  Query query;
+  std::wistringstream words(text);
+  std::wstring word;
+  while (words >> word && query.terms.size() < MAX_TERMS) {
+    if (parseExtensionFilter(word, query.extensions) ||
+        parseMetadataFilter(word, query.metadata) || parseSortKey(word, query.sortKey)) {
+      continue;
+    }
+    Term term;
+    size_t start = 0;
+    for (size_t i = 0; i <= word.size(); ++i) {
+      if (i < word.size() && !isSeparator(word[i])) {
+        continue;
+      }
+      // keep an empty last segment, it lists the content of the folders
+      const bool isLast = i == word.size();
+      if (i > start || (isLast && !term.empty())) {
+        const std::wstring needle = word.substr(start, i - start);
+        term.push_back({needle, getFuzzyReplacements(needle.size())});
+      }
+      start = i + 1;
+    }
+    if (!term.empty()) {
+      query.terms.push_back(std::move(term));
+    }
+  }
+  return query;
+}
+
+const Query::Segment& Query::getSimpleSegment() const {
+  static const Segment empty;
+  return terms.empty() ? empty : terms[0][0];
+}
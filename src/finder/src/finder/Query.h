@@ -0,0 +1,62 @@
+#pragma once
+
+#include <finder/MetadataColumns.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief A search query taken apart into terms and path segments.
+ *
+ * Terms are separated by spaces and all of them have to match (AND): each one the
+ * name of the entry or of one of its folders, at least one the name of the entry.
+ * A term of several segments separated by '/' matches a path: its last segment
+ * the name of the entry, the segments before the names of the folders directly
+ * above it, e.g. "finder/tree" finds Tree.cpp in the folder finder. An empty last
+ * segment matches every name, "finder/" finds the content of the folder finder.
+ * Terms like "ext:cpp,h" or "*.cpp" are no names but filter the files by extension.
+ * "size:>100m" and "size:<1g" filter by size (k, m, g, t: KiB to TiB), "modified:<7d"
+ * and "modified:>1y" by the time since the last change (h, d, w, y). "sort:size" and
+ * "sort:modified" rank the largest or newest first instead of the best names.
+ */
+struct Query {
+  struct Segment {
+    std::wstring needle;
+    size_t numFuzzyReplacements = 0;
+  };
+  // the segments of a term, the outermost folder first
+  using Term = std::vector<Segment>;
+
+  // more terms are ignored
+  static constexpr size_t MAX_TERMS = 64;
+
+  std::vector<Term> terms;
+  // lower case, without the dot. Empty: no filter.
+  std::vector<std::wstring> extensions;
+  MetadataFilter metadata;
+  enum class SortKey { SCORE, SIZE, MODIFICATION_TIME } sortKey = SortKey::SCORE;
+
+  /*!
+   * \brief Split the query, empty terms and empty segments inside a term are dropped.
+   * \param getFuzzyReplacements The fuzzy replacements allowed for a needle of the
+   * given length.
+   */
+  static Query parse(const std::wstring& text,
+                     const std::function<size_t(size_t)>& getFuzzyReplacements);
+
+  /*!
+   * \brief At most one term of one segment, no filter and ranked by score, a plain
+   * search for getSimpleSegment().
+   */
+  bool isSimple() const {
+    return extensions.empty() && !metadata.isActive() && sortKey == SortKey::SCORE &&
+           terms.size() <= 1 && (terms.empty() || terms[0].size() == 1);
+  }
+
+  /*!
+   * \brief The needle of a simple query, empty for an empty query.
+   */
+  const Segment& getSimpleSegment() const;
+};
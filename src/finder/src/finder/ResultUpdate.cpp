@@ -0,0 +1,75 @@
+#include <finder/ResultUpdate.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+bool diffResults(const std::vector<EntryId>& from,
+                 const std::vector<EntryId>& to,
+                 const size_t maxChanges,
+                 std::vector<ResultChange>& changes) {
+  changes.clear();
+
+  // first drop everything which is gone, neighbouring rows are removed in one go
+  const std::unordered_set<EntryId> wanted(to.begin(), to.end());
+  std::vector<EntryId> current;
+  current.reserve(from.size());
+  for (size_t i = 0; i < from.size(); ++i) {
+    if (wanted.count(from[i]) != 0) {
+      current.push_back(from[i]);
+      continue;
+    }
+    const size_t position = current.size();
+    if (!changes.empty() && changes.back().type == ResultChange::Type::REMOVE &&
+        changes.back().position == position) {
+      ++changes.back().count;
+    } else {
+      changes.push_back({ResultChange::Type::REMOVE, position, 1, 0, {}});
+    }
+    if (changes.size() > maxChanges) {
+      return false;
+    }
+  }
+
+  // then fill the ranking from the top: every row either is right already, is moved up
+  // from further below or is new. Consecutive new rows are inserted together.
+  std::unordered_set<EntryId> remaining(current.begin(), current.end());
+  for (size_t i = 0; i < to.size(); ++i) {
+    const EntryId id = to[i];
+    if (i < current.size() && current[i] == id) {
+      remaining.erase(id);
+      continue;
+    }
+    if (remaining.count(id) != 0) {
+      const auto source = std::find(current.begin() + i, current.end(), id);
+      const size_t position = static_cast<size_t>(source - current.begin());
+      std::rotate(current.begin() + i, source, source + 1);
+      remaining.erase(id);
+      changes.push_back({ResultChange::Type::MOVE, position, 0, i, {}});
+    } else {
+      current.insert(current.begin() + i, id);
+      if (!changes.empty() && changes.back().type == ResultChange::Type::INSERT &&
+          changes.back().position + changes.back().ids.size() == i) {
+        changes.back().ids.push_back(id);
+        continue;
+      }
+      changes.push_back({ResultChange::Type::INSERT, i, 0, 0, {id}});
+    }
+    if (changes.size() > maxChanges) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool fitsResults(const ResultChange& change, const size_t numResults) {
+  switch (change.type) {
+    case ResultChange::Type::INSERT:
+      return change.position <= numResults;
+    case ResultChange::Type::REMOVE:
+      // written to not overflow on a corrupted count
+      return change.position <= numResults && change.count <= numResults - change.position;
+    case ResultChange::Type::MOVE:
+      return change.position < numResults && change.target < numResults;
+  }
+  return false;
+}
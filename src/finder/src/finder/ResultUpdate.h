@@ -0,0 +1,101 @@
+#pragma once
+
+#include <finder/EntryId.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+/*!
+ * \brief One step turning the previously sent ranking of search results into the next one.
+ * Steps are applied in order, positions refer to the ranking as left by the previous step.
+ */
+struct ResultChange {
+  enum class Type { INSERT, REMOVE, MOVE };
+
+  Type type;
+  // INSERT: row of the first new entry, REMOVE: first removed row, MOVE: row moved away from
+  size_t position = 0;
+  // REMOVE: number of removed rows
+  size_t count = 0;
+  // MOVE: row the entry ends up in
+  size_t target = 0;
+  // INSERT: the new entries
+  std::vector<EntryId> ids;
+};
+
+/*!
+ * \brief Search results sent by the Finder: the complete ranking and the changes
+ * against the update numbered baseVersion.
+ *
+ * A receiver showing baseVersion applies the changes, every other receiver (or any
+ * receiver if reset is set) takes the whole ranking.
+ */
+struct ResultUpdate {
+  uint64_t version     = 0;
+  uint64_t baseVersion = 0;
+  bool reset           = true;
+  std::vector<ResultChange> changes;
+  // ids of the results, best first
+  std::vector<EntryId> ranking;
+
+  /*!
+   * \brief True if a receiver showing the update numbered shownVersion can apply the
+   * changes, otherwise it has to take the whole ranking.
+   */
+  bool appliesTo(const uint64_t shownVersion) const {
+    return !reset && baseVersion == shownVersion;
+  }
+};
+
+/*!
+ * \brief Compute the changes turning the ranking from into the ranking to.
+ * The ids in each ranking must be unique.
+ * \return false if more than maxChanges would be needed, sending everything is cheaper then.
+ */
+bool diffResults(const std::vector<EntryId>& from,
+                 const std::vector<EntryId>& to,
+                 const size_t maxChanges,
+                 std::vector<ResultChange>& changes);
+
+/*!
+ * \brief Returns true if the change can be applied to a ranking of numResults results.
+ */
+bool fitsResults(const ResultChange& change, const size_t numResults);
+
+/*!
+ * \brief Apply one change. It must fit the ranking, see fitsResults().
+ * The rows can be anything ranked like the ids, e.g. the paths a daemon client shows.
+ * \param inserted The rows an INSERT adds in place of change.ids, moved from if possible.
+ */
+template <typename Row, typename Rows>
+void applyResultChange(const ResultChange& change, std::vector<Row>& ranking, Rows&& inserted) {
+  switch (change.type) {
+    case ResultChange::Type::INSERT:
+      ranking.insert(ranking.begin() + change.position,
+                     std::make_move_iterator(std::begin(inserted)),
+                     std::make_move_iterator(std::end(inserted)));
+      break;
+    case ResultChange::Type::REMOVE:
+      ranking.erase(ranking.begin() + change.position,
+                    ranking.begin() + change.position + change.count);
+      break;
+    case ResultChange::Type::MOVE: {
+      const auto source = ranking.begin() + change.position;
+      const auto target = ranking.begin() + change.target;
+      if (change.target < change.position) {
+        std::rotate(target, source, source + 1);
+      } else {
+        std::rotate(source, source + 1, target + 1);
+      }
+      break;
+    }
+  }
+}
+
+inline void applyResultChange(const ResultChange& change, std::vector<EntryId>& ranking) {
+  applyResultChange(change, ranking, change.ids);
+}
+
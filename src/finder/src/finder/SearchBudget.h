@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+/*!
+ * \brief How long a search may run. A search running out of its budget stops and keeps
+ * the matches found so far, its SearchProgress is not complete then.
+ */
+struct SearchBudget {
+  using Clock = std::chrono::steady_clock;
+
+  Clock::time_point deadline = Clock::time_point::max();
+  size_t maxNodesVisited     = std::numeric_limits<size_t>::max();
+
+  /*!
+   * \brief A budget starting now, a limit of zero means unlimited.
+   */
+  static SearchBudget fromNow(const std::chrono::milliseconds timeLimit,
+                              const size_t maxNodesVisited) {
+    SearchBudget budget;
+    if (timeLimit.count() > 0) {
+      budget.deadline = Clock::now() + timeLimit;
+    }
+    if (maxNodesVisited > 0) {
+      budget.maxNodesVisited = maxNodesVisited;
+    }
+    return budget;
+  }
+
+  bool isLimited() const {
+    return deadline != Clock::time_point::max() ||
+           maxNodesVisited != std::numeric_limits<size_t>::max();
+  }
+};
+
+struct SearchProgress {
+  size_t nodesVisited = 0;
+  // false if the search ran out of its budget
+  bool complete = true;
+};
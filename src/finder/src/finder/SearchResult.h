@@ -0,0 +1,27 @@
+#pragma once
+
+#include <finder/Dictionary.h>
+#include <finder/ResultUpdate.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief What a search sends to its receiver: an immutable snapshot, shared by reference.
+ *
+ * It travels between threads as std::shared_ptr<const SearchResult>, nothing in it is
+ * copied on the way. Only ids are sent, the receiver decodes names and paths from the
+ * dictionary for the rows it actually shows.
+ */
+struct SearchResult {
+  bool finished = false;
+  // the search ran out of its budget, the results are the best found until then
+  bool incomplete = false;
+  std::wstring needle;
+  // the most common extensions of all matches, only counted for the finished results
+  std::vector<ExtensionCount> extensionCounts;
+  // the index the ids belong to. Keeps it alive even if a newer one gets published.
+  std::shared_ptr<const Dictionary> dictionary;
+  ResultUpdate update;
+};
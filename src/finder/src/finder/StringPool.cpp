@@ -0,0 +1,324 @@
+#include <finder/StringPool.h>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <stdexcept>
+
+StringPool::StringPool(const StringPool& other)
+    : pending(other.pending),
+      finalized(other.finalized),
+      numStrings(other.numStrings),
+      useHuffman(other.useHuffman),
+      huffman(other.huffman),
+      blockOffsets(other.blockOffsets),
+      blocks(other.blocks) {
+  for (size_t i = 0; i < pending.size(); ++i) {
+    pendingIds.emplace(pending[i], static_cast<StringId>(i));
+  }
+}
+
+StringPool& StringPool::operator=(const StringPool& other) {
+  if (this != &other) {
+    *this = StringPool(other);
+  }
+  return *this;
+}
+
+StringPool::StringId StringPool::add(const std::wstring& str) {
+  if (finalized) {
+    throw std::logic_error("StringPool: can not add to a finalized pool");
+  }
+  const auto it = pendingIds.find(str);
+  if (it != pendingIds.end()) {
+    return it->second;
+  }
+  // deque: the references stay valid, the map can point into the strings
+  pending.push_back(str);
+  const auto id = static_cast<StringId>(pending.size() - 1);
+  pendingIds.emplace(pending.back(), id);
+  return id;
+}
+
+size_t StringPool::size() const { return finalized ? numStrings : pending.size(); }
+
+size_t StringPool::getMemoryUsage() const {
+  size_t bytes = blocks.capacity() + blockOffsets.capacity() * sizeof(uint32_t);
+  for (const auto& str : pending) {
+    bytes += sizeof(std::wstring) + (str.capacity() + 1) * sizeof(wchar_t);
+  }
+  bytes += pendingIds.bucket_count() * sizeof(void*) +
+           pendingIds.size() * (sizeof(decltype(pendingIds)::value_type) + 2 * sizeof(void*));
+  return bytes;
+}
+
+std::vector<StringPool::StringId> StringPool::finalize(const bool useEntropyCoder) {
+  std::vector<std::string> utf8;
+  utf8.reserve(pending.size());
+  for (const auto& str : pending) {
+    utf8.push_back(toUtf8(str));
+  }
+
+  std::vector<StringId> order(utf8.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&utf8](StringId a, StringId b) {
+    return utf8[a] < utf8[b];
+  });
+
+  std::vector<StringId> newIds(utf8.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    newIds[order[i]] = static_cast<StringId>(i);
+  }
+
+  // front code the sorted strings into blocks
+  std::vector<std::string> rawBlocks;
+  for (size_t i = 0; i < order.size(); ++i) {
+    const std::string& str = utf8[order[i]];
+    if (i % BLOCK_SIZE == 0) {
+      rawBlocks.emplace_back();
+      BinaryWriter writer;
+      writer.writeString(str);
+      rawBlocks.back().append(writer.getBuffer().begin(), writer.getBuffer().end());
+      continue;
+    }
+    const std::string& previous = utf8[order[i - 1]];
+    const size_t maxShared      = std::min(previous.size(), str.size());
+    size_t shared               = 0;
+    while (shared < maxShared && previous[shared] == str[shared]) {
+      ++shared;
+    }
+    BinaryWriter writer;
+    writer.writeVarint(shared);
+    writer.writeString(std::string_view(str).substr(shared));
+    rawBlocks.back().append(writer.getBuffer().begin(), writer.getBuffer().end());
+  }
+
+  useHuffman = useEntropyCoder && !rawBlocks.empty();
+  if (useHuffman) {
+    std::array<uint64_t, HuffmanCoder::NUM_SYMBOLS> frequencies{};
+    for (const auto& block : rawBlocks) {
+      for (const char c : block) {
+        ++frequencies[static_cast<uint8_t>(c)];
+      }
+    }
+    huffman.build(frequencies);
+  }
+
+  blocks.clear();
+  blockOffsets.clear();
+  blockOffsets.reserve(rawBlocks.size());
+  for (const auto& block : rawBlocks) {
+    blockOffsets.push_back(static_cast<uint32_t>(blocks.size()));
+    if (useHuffman) {
+      BinaryWriter writer;
+      writer.writeVarint(block.size());
+      blocks.insert(blocks.end(), writer.getBuffer().begin(), writer.getBuffer().end());
+      huffman.encode(block, blocks);
+    } else {
+      blocks.insert(blocks.end(), block.begin(), block.end());
+    }
+  }
+
+  numStrings = utf8.size();
+  finalized  = true;
+  pendingIds.clear();
+  pending.clear();
+  return newIds;
+}
+
+std::string StringPool::decodeBlock(const size_t blockIndex) const {
+  const size_t begin = blockOffsets[blockIndex];
+  const size_t end =
+    blockIndex + 1 < blockOffsets.size() ? blockOffsets[blockIndex + 1] : blocks.size();
+  if (begin > end || end > blocks.size()) {
+    throw std::runtime_error("Corrupted index: invalid string block offsets");
+  }
+  if (!useHuffman) {
+    return std::string(blocks.data() + begin, end - begin);
+  }
+  BinaryReader reader(blocks.data() + begin, end - begin);
+  const size_t rawSize = reader.readVarint();
+  // every symbol needs at least one bit
+  if (rawSize > reader.remaining() * 8) {
+    throw std::runtime_error("Corrupted index: invalid string block size");
+  }
+  std::string raw;
+  const size_t headerSize = reader.getPosition();
+  huffman.decode(blocks.data() + begin + headerSize, end - begin - headerSize, rawSize, raw);
+  return raw;
+}
+
+std::wstring StringPool::get(const StringId id) const {
+  if (!finalized) {
+    return pending.at(id);
+  }
+  if (id >= numStrings) {
+    throw std::out_of_range("StringPool: invalid string id");
+  }
+  const std::string raw = decodeBlock(id / BLOCK_SIZE);
+  BinaryReader reader(raw.data(), raw.size());
+
+  std::string current(reader.readString());
+  for (size_t i = 0; i < id % BLOCK_SIZE; ++i) {
+    const size_t shared = reader.readVarint();
+    if (shared > current.size()) {
+      throw std::runtime_error("Corrupted index: invalid shared prefix");
+    }
+    current.resize(shared);
+    current.append(reader.readString());
+  }
+  return fromUtf8(current);
+}
+
+void StringPool::forEach(
+  const std::function<void(const StringId, const std::wstring&)>& func) const {
+  StringId id = 0;
+  for (size_t block = 0; block < blockOffsets.size(); ++block) {
+    const std::string raw = decodeBlock(block);
+    BinaryReader reader(raw.data(), raw.size());
+    std::string current;
+    for (size_t i = 0; i < BLOCK_SIZE && id < numStrings; ++i, ++id) {
+      const size_t shared = i == 0 ? 0 : reader.readVarint();
+      if (shared > current.size()) {
+        throw std::runtime_error("Corrupted index: invalid shared prefix");
+      }
+      current.resize(shared);
+      current.append(reader.readString());
+      func(id, fromUtf8(current));
+    }
+  }
+}
+
+void StringPool::serialize(BinaryWriter& writer) const {
+  if (!finalized) {
+    throw std::logic_error("StringPool: finalize() before serializing");
+  }
+  writer.writeVarint(numStrings);
+  writer.writePod<uint8_t>(useHuffman ? 1 : 0);
+  if (useHuffman) {
+    const auto& lengths = huffman.getCodeLengths();
+    writer.writeBytes(lengths.data(), lengths.size());
+  }
+  writer.writeVarint(blockOffsets.size());
+  uint32_t previous = 0;
+  for (const uint32_t offset : blockOffsets) {
+    writer.writeVarint(offset - previous);
+    previous = offset;
+  }
+  writer.writeVarint(blocks.size());
+  writer.writeBytes(blocks.data(), blocks.size());
+}
+
+void StringPool::deserialize(BinaryReader& reader) {
+  pending.clear();
+  pendingIds.clear();
+
+  numStrings = reader.readVarint();
+  useHuffman = reader.readPod<uint8_t>() != 0;
+  if (useHuffman) {
+    HuffmanCoder::CodeLengths lengths{};
+    const auto bytes = reader.readBytes(lengths.size());
+    std::copy(bytes.begin(), bytes.end(), lengths.begin());
+    huffman.setCodeLengths(lengths);
+  }
+
+  const size_t numBlocks = reader.readCount();
+  if (numBlocks != (numStrings + BLOCK_SIZE - 1) / BLOCK_SIZE) {
+    throw std::runtime_error("Corrupted index: string pool block count mismatch");
+  }
+  blockOffsets.resize(numBlocks);
+  uint64_t offset = 0;
+  for (auto& blockOffset : blockOffsets) {
+    offset += reader.readVarint();
+    blockOffset = static_cast<uint32_t>(offset);
+  }
+  const size_t numBytes = reader.readCount();
+  if (offset > numBytes) {
+    throw std::runtime_error("Corrupted index: string block offset out of range");
+  }
+  const auto bytes = reader.readBytes(numBytes);
+  blocks.assign(bytes.begin(), bytes.end());
+  finalized = true;
+}
+
+std::string StringPool::toUtf8(std::wstring_view str) {
+  std::string out;
+  out.reserve(str.size());
+  for (size_t i = 0; i < str.size(); ++i) {
+    auto cp = static_cast<uint32_t>(str[i]);
+    // utf16 (windows): combine surrogate pairs
+    if constexpr (sizeof(wchar_t) == 2) {
+      if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < str.size()) {
+        const auto low = static_cast<uint32_t>(str[i + 1]);
+        if (low >= 0xDC00 && low <= 0xDFFF) {
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+          ++i;
+        }
+      }
+    }
+    if (cp < 0x80) {
+      out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+      out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+      out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+      out.push_back(static_cast<char>(0xF0 | ((cp >> 18) & 0x07)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+  }
+  return out;
+}
+
+std::wstring StringPool::fromUtf8(std::string_view str) {
+  constexpr uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
+  std::wstring out;
+  out.reserve(str.size());
+  size_t i = 0;
+  while (i < str.size()) {
+    const auto lead = static_cast<uint8_t>(str[i]);
+    uint32_t cp     = 0;
+    size_t numFollowing;
+    if (lead < 0x80) {
+      cp           = lead;
+      numFollowing = 0;
+    } else if ((lead & 0xE0) == 0xC0) {
+      cp           = lead & 0x1F;
+      numFollowing = 1;
+    } else if ((lead & 0xF0) == 0xE0) {
+      cp           = lead & 0x0F;
+      numFollowing = 2;
+    } else if ((lead & 0xF8) == 0xF0) {
+      cp           = lead & 0x07;
+      numFollowing = 3;
+    } else {
+      out.push_back(static_cast<wchar_t>(REPLACEMENT_CHARACTER));
+      ++i;
+      continue;
+    }
+    if (i + numFollowing >= str.size() && numFollowing > 0) {
+      out.push_back(static_cast<wchar_t>(REPLACEMENT_CHARACTER));
+      break;
+    }
+    for (size_t k = 1; k <= numFollowing; ++k) {
+      cp = (cp << 6) | (static_cast<uint8_t>(str[i + k]) & 0x3F);
+    }
+    i += numFollowing + 1;
+
+    if constexpr (sizeof(wchar_t) == 2) {
+      if (cp >= 0x10000) {
+        cp -= 0x10000;
+        out.push_back(static_cast<wchar_t>(0xD800 + (cp >> 10)));
+        out.push_back(static_cast<wchar_t>(0xDC00 + (cp & 0x3FF)));
+        continue;
+      }
+    }
+    out.push_back(static_cast<wchar_t>(cp));
+  }
+  return out;
+}
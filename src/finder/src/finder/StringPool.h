@@ -0,0 +1,91 @@
+#pragma once
+
+#include <finder/BinaryIO.h>
+#include <finder/HuffmanCoder.h>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * \brief Stores file and folder names once, compressed.
+ *
+ * While indexing, strings are collected uncompressed and deduplicated.
+ * finalize() sorts them and front codes them in blocks of BLOCK_SIZE strings:
+ * the first string of a block is stored completely, every following one only as
+ * the length of the prefix it shares with its predecessor plus the remaining suffix.
+ * Strings are stored as utf8. Optionally every block is huffman coded on top.
+ * A string is decoded on demand by decoding its block up to the string.
+ */
+class StringPool {
+ public:
+  using StringId                     = uint32_t;
+  static constexpr size_t BLOCK_SIZE = 16;
+
+  StringPool() = default;
+  // the lookup while building points into the strings, it must be rebuild on copy
+  StringPool(const StringPool& other);
+  StringPool& operator=(const StringPool& other);
+  StringPool(StringPool&&)            = default;
+  StringPool& operator=(StringPool&&) = default;
+
+  /*!
+   * \brief Add a string while building. Returns the id of an equal string if
+   * there already is one. Ids change with finalize().
+   */
+  StringId add(const std::wstring& str);
+
+  /*!
+   * \brief Sort and compress all strings.
+   * \param useEntropyCoder Huffman code the blocks additionally.
+   * \return For every id returned by add() the id after finalizing.
+   */
+  std::vector<StringId> finalize(const bool useEntropyCoder);
+
+  bool isFinalized() const { return finalized; }
+
+  std::wstring get(const StringId id) const;
+
+  /*!
+   * \brief Call func(id, string) for all strings in id order (after finalize()).
+   * Much faster than get() for every id, each block is decoded only once.
+   */
+  void forEach(const std::function<void(const StringId, const std::wstring&)>& func) const;
+
+  size_t size() const;
+
+  /*!
+   * \brief Bytes used by the compressed blocks (after finalize()).
+   */
+  size_t getCompressedSize() const { return blocks.size(); }
+
+  /*!
+   * \brief Heap bytes of the pool, while building too.
+   */
+  size_t getMemoryUsage() const;
+
+  void serialize(BinaryWriter& writer) const;
+  void deserialize(BinaryReader& reader);
+
+  static std::string toUtf8(std::wstring_view str);
+  static std::wstring fromUtf8(std::string_view str);
+
+ private:
+  std::string decodeBlock(const size_t blockIndex) const;
+
+  // building
+  std::deque<std::wstring> pending;
+  std::unordered_map<std::wstring_view, StringId> pendingIds;
+
+  // finalized
+  bool finalized    = false;
+  size_t numStrings = 0;
+  bool useHuffman   = false;
+  HuffmanCoder huffman;
+  std::vector<uint32_t> blockOffsets;
+  std::vector<char> blocks;
+};
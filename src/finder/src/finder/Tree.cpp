@@ -7,9 +7,7 @@
 Tree::Tree() : _root(std::make_unique<TreeNode>(0)) {}
 
 
-void Tree::insertWord(const std::wstring &word,
-                      const std::filesystem::path &path,
-                      const bool isDirectory) {
+void Tree::insertWord(const std::wstring &word, const EntryId id) {
   TreeNode *nodePtr = _root.get();
   size_t remaining_depth = word.size();
   nodePtr->_depth = std::max(remaining_depth, nodePtr->_depth);
@@ -22,24 +20,41 @@ void Tree::insertWord(const std::wstring &word,
     nodePtr = nodePtr->_children[letter];
     nodePtr->_depth = std::max(remaining_depth, nodePtr->_depth);
   }
-  nodePtr->_paths.emplace_back(path, isDirectory);
+  nodePtr->_entries.push_back(id);
 }
 
-void Tree::traverse(const TreeNode *rootSubT, std::vector<TreeNode::PathInfo> &pathList) const {
+bool Tree::SearchVariables::visit() {
+  // reading the clock costs more than a node, only look at it every now and then
+  constexpr size_t DEADLINE_CHECK_INTERVAL = 256;
+  ++progress.nodesVisited;
+  if (progress.complete &&
+      (progress.nodesVisited > budget.maxNodesVisited ||
+       (progress.nodesVisited % DEADLINE_CHECK_INTERVAL == 0 &&
+        SearchBudget::Clock::now() > budget.deadline))) {
+    progress.complete = false;
+  }
+  return !progress.complete || stopSearch.load();
+}
+
+void Tree::traverse(const TreeNode *rootSubT, SearchVariables &vars) const {
+  // a short needle ends up here with most of the tree below, so this is budgeted too
+  if (vars.visit()) {
+    return;
+  }
   if (rootSubT->isLeaf()) {
-    pathList.insert(
-        std::end(pathList), std::cbegin(rootSubT->_paths), std::cend(rootSubT->_paths));
+    vars.result.insert(
+        std::end(vars.result), std::cbegin(rootSubT->_entries), std::cend(rootSubT->_entries));
   }
 
   if (!rootSubT->_children.empty()) {
     for (const auto &[letter, tnPtr] : rootSubT->_children) {
-      traverse(tnPtr, pathList);
+      traverse(tnPtr, vars);
     }
   }
 }
 
 void Tree::searchHelper(const TreeNode *nodePtr, SearchVariables &vars) const {
-  if (vars.stopSearch.load()) {
+  if (vars.visit()) {
     return;
   }
 
@@ -50,7 +65,7 @@ void Tree::searchHelper(const TreeNode *nodePtr, SearchVariables &vars) const {
   if (vars.needle.found()) {
     // Base case: we’ve processed all prefix characters, traverse the remaining tree
     vars.dontVisitAgain.insert(nodePtr);  // actually we can go back further to the next branch, but this adds more complexity and the time benefit might be small
-    traverse(nodePtr, vars.result);
+    traverse(nodePtr, vars);
     return;
   }
 
@@ -130,22 +145,181 @@ void Tree::searchHelper(const TreeNode *nodePtr, SearchVariables &vars) const {
   vars.needle.undo_useFuzzySeaerch();
 }
 
-void Tree::search(Needle needle,
-                  std::atomic<bool> &stopSearch,
-                  std::vector<TreeNode::PathInfo> &matches) const {
+SearchProgress Tree::search(Needle needle,
+                            std::atomic<bool> &stopSearch,
+                            const SearchBudget &budget,
+                            std::vector<EntryId> &matches) const {
   const TreeNode *nodePtr = _root.get();
-  SearchVariables vars(needle, matches, stopSearch);
+  SearchVariables vars(needle, matches, stopSearch, budget);
   searchHelper(nodePtr, vars);
+  return vars.progress;
+}
+
+namespace {
+// a node and how much of the needle is matched up to it
+struct SearchPosition {
+  const TreeNode *node;
+  size_t index;
+
+  bool operator==(const SearchPosition &) const = default;
+};
+
+struct SearchPositionHash {
+  size_t operator()(const SearchPosition &position) const {
+    return std::hash<const TreeNode *>()(position.node) ^ (position.index * 0x9e3779b97f4a7c15);
+  }
+};
+
+struct SearchState {
+  SearchPosition position;
+  size_t edits;
+  // in the reached positions
+  bool remembered;
+};
+}  // namespace
+
+SearchProgress Tree::searchBestFirst(Needle needle,
+                                     std::atomic<bool> &stopSearch,
+                                     const SearchBudget &budget,
+                                     std::vector<EntryId> &matches,
+                                     const std::function<bool(size_t)> &continueWithEdits) const {
+  // only for its budget, the position in the needle is part of every state instead
+  SearchVariables vars(needle, matches, stopSearch, budget);
+  const size_t needleSize = needle.getSize();
+  const size_t maxEdits   = needle.getNumFuzzyChanges();
+
+  // the fewest edits a position was reached with, a position is expanded only once
+  std::unordered_map<SearchPosition, size_t, SearchPositionHash> reached;
+  // A priority queue by the fewest edits a state needs, the edits plus the letters of
+  // the needle which do not fit into the names below. These never decrease along the
+  // search, so one stack per number of edits does. The stacks expand the states added
+  // last first, those are the further matched ones.
+  std::vector<std::vector<SearchState>> frontier(maxEdits + 1);
+  auto add = [&](const TreeNode *node, const size_t index, const size_t edits) {
+    const size_t remaining = needleSize - index;
+    const size_t depth     = node->getMaxWordLength();
+    const size_t minEdits  = edits + (remaining > depth ? remaining - depth : 0);
+    if (minEdits > maxEdits) {
+      return;
+    }
+    // A node is reached only once before the needle starts, from its parent. Without
+    // edits left a state only follows its letters, doing that twice is cheaper than
+    // remembering all of them.
+    const bool remember = index > 0 && edits < maxEdits;
+    if (remember) {
+      const auto [it, inserted] = reached.try_emplace({node, index}, edits);
+      if (!inserted) {
+        if (it->second <= edits) {
+          return;
+        }
+        it->second = edits;
+      }
+    }
+    frontier[minEdits].push_back({{node, index}, edits, remember});
+  };
+  add(_root.get(), 0, 0);
+
+  std::unordered_set<const TreeNode *> traversed;
+  std::vector<const TreeNode *> subtree;
+  size_t currentEdits = 0;
+  while (true) {
+    while (currentEdits <= maxEdits && frontier[currentEdits].empty()) {
+      ++currentEdits;
+      if (currentEdits <= maxEdits && !continueWithEdits(currentEdits)) {
+        return vars.progress;
+      }
+    }
+    if (currentEdits > maxEdits) {
+      break;
+    }
+    const SearchState state = frontier[currentEdits].back();
+    frontier[currentEdits].pop_back();
+    if (state.remembered && reached.at(state.position) < state.edits) {
+      continue;  // reached with fewer edits after this one was added
+    }
+    if (vars.visit()) {
+      break;
+    }
+
+    const TreeNode *node = state.position.node;
+    const size_t index   = state.position.index;
+    if (index == needleSize) {
+      // every name below matches, collect those not collected by another match yet
+      subtree.assign(1, node);
+      while (!subtree.empty() && !vars.visit()) {
+        const TreeNode *next = subtree.back();
+        subtree.pop_back();
+        if (!traversed.insert(next).second) {
+          continue;
+        }
+        matches.insert(matches.end(), next->_entries.begin(), next->_entries.end());
+        for (const auto &child : next->_children) {
+          subtree.push_back(child.second);
+        }
+      }
+      continue;
+    }
+
+    // the tree stores the letters narrowed to char, see insertWord()
+    const wchar_t letter  = static_cast<char>(needle.getLetter(index));
+    const bool isWildCard = needle.isWildCard(index);
+    const bool canEdit    = state.edits < maxEdits;
+    for (const auto &[childLetter, child] : node->_children) {
+      if (index == 0) {
+        add(child, 0, state.edits);  // the needle may start anywhere in the name
+      }
+      if (isWildCard || childLetter == letter) {
+        add(child, index + 1, state.edits);
+      } else if (canEdit) {
+        add(child, index + 1, state.edits + 1);  // replace the letter of the needle
+      }
+      if (canEdit && index > 0) {
+        add(child, index, state.edits + 1);  // insert the letter of the name
+      }
+    }
+    if (canEdit) {
+      add(node, index + 1, state.edits + 1);  // delete the letter of the needle
+    }
+  }
+  return vars.progress;
 }
 
 size_t Tree::getMaxEntryLength() const { return _root->_depth; }
 
-void Tree::serialize(std::wofstream &outFile) const {
-  _root->serialize(outFile);
+std::unique_ptr<Tree> Tree::clone() const {
+  auto copy   = std::make_unique<Tree>();
+  copy->_root = std::unique_ptr<TreeNode>(_root->clone());
+  return copy;
 }
 
-void Tree::deserialize(std::wifstream &inFile) {
-  _root = std::unique_ptr<TreeNode>(TreeNode::deserialize(inFile));
+void Tree::collectStatistics(IndexStatistics &statistics) const {
+  using ChildMap = decltype(TreeNode::_children);
+  // per element the map allocates a node with the value and the pointer to the next one
+  constexpr size_t MAP_NODE_BYTES = sizeof(ChildMap::value_type) + sizeof(void *);
+
+  // iterative, a long name would make a deep recursion.
+  // A run counts the nodes with one child and no entries directly above a node.
+  std::vector<std::pair<const TreeNode *, size_t>> stack{{_root.get(), 0}};
+  while (!stack.empty()) {
+    const auto [node, run] = stack.back();
+    stack.pop_back();
+
+    ++statistics.numNodes;
+    statistics.numLeaves += node->isLeaf() ? 1 : 0;
+    IndexStatistics::add(statistics.fanOut, node->_children.size());
+    statistics.bytes.nodes += sizeof(TreeNode);
+    statistics.bytes.childMaps +=
+      node->_children.bucket_count() * sizeof(void *) + node->_children.size() * MAP_NODE_BYTES;
+    statistics.bytes.entryVectors += node->_entries.capacity() * sizeof(EntryId);
+
+    const bool continuesRun = node->_children.size() == 1 && !node->isLeaf();
+    if (!continuesRun && run > 0) {
+      IndexStatistics::add(statistics.chainLength, run);
+    }
+    for (const auto &[letter, child] : node->_children) {
+      stack.emplace_back(child, continuesRun ? run + 1 : 0);
+    }
+  }
 }
 
 void Tree::generateDotFile(const std::string &filename) const {
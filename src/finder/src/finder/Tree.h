@@ -1,12 +1,15 @@
 #pragma once
 
+#include <finder/IndexStatistics.h>
 #include <finder/Needle.h>
+#include <finder/SearchBudget.h>
 #include <finder/TreeNode.h>
 
 #include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -20,15 +23,24 @@ class Tree {
 
   struct SearchVariables {
     Needle &needle;
-    std::vector<TreeNode::PathInfo> &result;
+    std::vector<EntryId> &result;
     std::atomic<bool> &stopSearch;
+    const SearchBudget &budget;
     std::unordered_set<const TreeNode *> dontVisitAgain;
+    SearchProgress progress;
 
     // Constructor
     SearchVariables(Needle &needle_,
-                    std::vector<TreeNode::PathInfo> &result_,
-                    std::atomic<bool> &stopSearch_)
-        : needle(needle_), result(result_), stopSearch(stopSearch_) {}
+                    std::vector<EntryId> &result_,
+                    std::atomic<bool> &stopSearch_,
+                    const SearchBudget &budget_)
+        : needle(needle_), result(result_), stopSearch(stopSearch_), budget(budget_) {}
+
+    /*!
+     * \brief Count a visited node.
+     * \return True if the search has to stop, because it got stopped or is out of budget.
+     */
+    bool visit();
   };
 
  public:
@@ -39,17 +51,44 @@ class Tree {
 
   size_t getMaxEntryLength() const;
 
-  void insertWord(const std::wstring &, const std::filesystem::path &, const bool);
+  void insertWord(const std::wstring &, const EntryId);
 
   void searchHelper(const TreeNode *nodePtr, SearchVariables &) const;
 
-  void search(Needle, std::atomic<bool> &, std::vector<TreeNode::PathInfo> &matches) const;
-
-  void serialize(std::wofstream &outFile) const;
-  void deserialize(std::wifstream &inFile);
+  /*!
+   * \brief Append the entries whose name contains the needle to matches.
+   * \return The number of visited nodes, the work the search took, and whether it
+   * finished within the budget.
+   */
+  SearchProgress search(Needle,
+                        std::atomic<bool> &,
+                        const SearchBudget &,
+                        std::vector<EntryId> &matches) const;
+
+  /*!
+   * \brief Like search(), but best-first: the states of the search are expanded in the
+   * order of the fewest edits they need at least, so the exact matches come first.
+   * Unlike search(), edits are tried at every letter, every name within the fuzzy
+   * changes of the needle is found.
+   * \param continueWithEdits Called before the first state needing this many edits is
+   * expanded, returning false ends the search. All matches with fewer edits are in
+   * matches by then.
+   */
+  SearchProgress searchBestFirst(Needle,
+                                 std::atomic<bool> &,
+                                 const SearchBudget &,
+                                 std::vector<EntryId> &matches,
+                                 const std::function<bool(size_t)> &continueWithEdits) const;
+
+  std::unique_ptr<Tree> clone() const;
+
+  /*!
+   * \brief Fill the node counts, histograms and node bytes of the statistics.
+   */
+  void collectStatistics(IndexStatistics &statistics) const;
 
   void generateDotFile(const std::string &filename) const;
 
  private:
-  void traverse(const TreeNode *, std::vector<TreeNode::PathInfo> &) const;
+  void traverse(const TreeNode *, SearchVariables &) const;
 };
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <finder/EntryId.h>
+
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <unordered_map>
@@ -18,21 +21,14 @@ struct TreeNode {
 
   size_t _depth;
   std::unordered_map<wchar_t, TreeNode*> _children;
-  struct PathInfo {
-    PathInfo(const std::filesystem::path& path, const bool isDir)
-        : path(path), isDirectory(isDir) {}
-    std::filesystem::path path;
-    bool isDirectory;
-  };
-
-  std::vector<PathInfo> _paths;
+  // the entries of the PathTable whose name ends here
+  std::vector<EntryId> _entries;
 
   size_t getMaxWordLength() const;
 
   bool isLeaf() const;
 
-  void serialize(std::wofstream& outFile) const;
-  static TreeNode* deserialize(std::wifstream& inFile);
+  TreeNode* clone() const;
 
   static void print2dot(const TreeNode* node, std::wofstream& file);
 };
@@ -0,0 +1,81 @@
+#include <finder/Worker.h>
+
+Worker::~Worker() { stop(); }
+
+void Worker::start(const Job& job) {
+  std::lock_guard<std::mutex> lock(mutex);
+  joinFinishedTasks();
+
+  if (current) {
+    current->stop->store(true);
+    cancelled.push_back(std::move(current));
+  }
+
+  current = std::make_unique<Task>();
+  // the thread only owns copies of the tokens, the Task may be moved around meanwhile
+  current->thread = std::thread([job, stop = current->stop, done = current->done]() {
+    job(*stop);
+    done->store(true);
+  });
+}
+
+void Worker::cancel() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (current) {
+    current->stop->store(true);
+    cancelled.push_back(std::move(current));
+  }
+  joinFinishedTasks();
+}
+
+void Worker::stop() {
+  std::vector<std::unique_ptr<Task>> toJoin;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current) {
+      current->stop->store(true);
+      cancelled.push_back(std::move(current));
+    }
+    toJoin.swap(cancelled);
+  }
+  // join outside of the lock, a finishing job might want to start a new one
+  for (auto& task : toJoin) {
+    if (task->thread.joinable()) {
+      task->thread.join();
+    }
+  }
+}
+
+void Worker::wait() {
+  std::vector<std::unique_ptr<Task>> toJoin;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current) {
+      cancelled.push_back(std::move(current));
+    }
+    toJoin.swap(cancelled);
+  }
+  for (auto& task : toJoin) {
+    if (task->thread.joinable()) {
+      task->thread.join();
+    }
+  }
+}
+
+bool Worker::isWorking() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return current && !current->done->load();
+}
+
+void Worker::joinFinishedTasks() {
+  for (auto it = cancelled.begin(); it != cancelled.end();) {
+    if ((*it)->done->load()) {
+      if ((*it)->thread.joinable()) {
+        (*it)->thread.join();
+      }
+      it = cancelled.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
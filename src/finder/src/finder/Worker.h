@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * \brief Executes one job at a time on its own thread.
+ *
+ * Every job gets its own cancellation token. Starting a new job only cancels
+ * the running one, it does not wait for it. Cancelled threads are joined as
+ * soon as they are found to be finished, or latest when the Worker is destroyed.
+ * This way the caller (usually the GUI thread) never blocks in join().
+ */
+class Worker {
+ public:
+  using Job = std::function<void(std::atomic<bool>& stop)>;
+
+  Worker() = default;
+  Worker(const Worker&)            = delete;
+  Worker& operator=(const Worker&) = delete;
+  ~Worker();
+
+  /*!
+   * \brief Cancel the current job (non blocking) and run the given job on a new thread.
+   * \param job The job. It must return soon after its stop token is set.
+   */
+  void start(const Job& job);
+
+  /*!
+   * \brief Request the current job to stop. Does not block.
+   */
+  void cancel();
+
+  /*!
+   * \brief Cancel the current job and wait for all threads to finish.
+   */
+  void stop();
+
+  /*!
+   * \brief Wait for the current job to finish without cancelling it.
+   * Cancelled jobs are joined as well.
+   */
+  void wait();
+
+  /*!
+   * \brief Returns true if a job is running which was not cancelled.
+   */
+  bool isWorking() const;
+
+ private:
+  struct Task {
+    std::thread thread;
+    std::shared_ptr<std::atomic<bool>> stop = std::make_shared<std::atomic<bool>>(false);
+    std::shared_ptr<std::atomic<bool>> done = std::make_shared<std::atomic<bool>>(false);
+  };
+
+  void joinFinishedTasks();
+
+  mutable std::mutex mutex;
+  std::unique_ptr<Task> current;
+  std::vector<std::unique_ptr<Task>> cancelled;
+};
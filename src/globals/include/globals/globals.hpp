@@ -68,11 +68,12 @@ class Globals {
       }
     }
 
-    absolute_path_to_base       = abs_path_to_base;
-    absolute_path_to_executable = current_path;
-    absolute_path_to_resources  = absolute_path_to_base / RESOURCES_FOLDER_NAME;
-    absolute_path_to_save_files = absolute_path_to_base / SAVE_FOLDER_NAME;
-    absolute_path_to_settings   = absolute_path_to_base / SETTINGS_FOLDER_NAME;
+    absolute_path_to_base        = abs_path_to_base;
+    absolute_path_to_executable  = current_path;
+    absolute_path_to_resources   = absolute_path_to_base / RESOURCES_FOLDER_NAME;
+    absolute_path_to_save_files  = absolute_path_to_base / SAVE_FOLDER_NAME;
+    absolute_path_to_settings    = absolute_path_to_base / SETTINGS_FOLDER_NAME;
+    absolute_path_to_index_cache = absolute_path_to_save_files / INDEX_CACHE_FOLDER_NAME;
 
     if (!fs::exists(absolute_path_to_resources)) {
       std::runtime_error("The expected Path " +
@@ -88,6 +89,9 @@ class Globals {
     if (!fs::exists(absolute_path_to_settings)) {
       fs::create_directory(absolute_path_to_settings);
     }
+    if (!fs::exists(absolute_path_to_index_cache)) {
+      fs::create_directory(absolute_path_to_index_cache);
+    }
   }
 
  public:
@@ -103,6 +107,20 @@ class Globals {
     return absolute_path_to_resources;
   }
 
+  /*!
+   * \brief The folder holding one index file per indexed root folder.
+   */
+  const std::filesystem::path& getAbsPath2IndexCache() const {
+    return absolute_path_to_index_cache;
+  }
+
+  /*!
+   * \brief The results the user opened, see OpenHistory.
+   */
+  std::filesystem::path getPath2OpenHistory() const {
+    return absolute_path_to_save_files / FILE_NAME_OPEN_HISTORY;
+  }
+
 
   const std::wstring& getBinaryTreeFromatIdentifier() const {
     return BINARY_FORMAT_IDENTIFIER;
@@ -122,7 +140,7 @@ class Globals {
     return std::to_string(Globals::VERSION) + " - " + VERSION_NAME;
   }
 
-  static constexpr uint32_t VERSION = 1;
+  static constexpr uint32_t VERSION = 4;
 
  private:
   // Absolute paths to folders
@@ -131,17 +149,20 @@ class Globals {
   std::filesystem::path absolute_path_to_executable;
   std::filesystem::path absolute_path_to_save_files;
   std::filesystem::path absolute_path_to_settings;
+  std::filesystem::path absolute_path_to_index_cache;
 
   // Folder names
-  const std::filesystem::path REPRO_FOLDER_NAME     = "fScout";
-  const std::filesystem::path RESOURCES_FOLDER_NAME = "resources";
-  const std::filesystem::path SAVE_FOLDER_NAME      = "saved_data";
-  const std::filesystem::path SETTINGS_FOLDER_NAME  = "settings";
+  const std::filesystem::path REPRO_FOLDER_NAME       = "fScout";
+  const std::filesystem::path RESOURCES_FOLDER_NAME   = "resources";
+  const std::filesystem::path SAVE_FOLDER_NAME        = "saved_data";
+  const std::filesystem::path SETTINGS_FOLDER_NAME    = "settings";
+  const std::filesystem::path INDEX_CACHE_FOLDER_NAME = "index_cache";
 
   // File names
   const std::filesystem::path FILE_NAME_DISPLAY_SETTINGS =
     "display_settings.txt";
   const std::filesystem::path FILE_NAME_FSCOUT_SETTINGS = "fScout_settings.txt";
+  const std::filesystem::path FILE_NAME_OPEN_HISTORY    = "open_history.bin";
 
   // Strings
   const std::string MAIN_WINDOW_NAME          = std::string("fScout");
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <ostream>
+
+/*!
+ * Scoped timers on the hot paths, enabled with the CMake option FSCOUT_INSTRUMENTATION.
+ *
+ *   void Dictionary::search(...) {
+ *     INSTRUMENT_SCOPE(SEARCH);
+ *     ...
+ *
+ * Every thread records the durations into its own histograms, so recording needs no
+ * lock. instrumentation::dump() prints p50/p99/max per thread and instrumentation point,
+ * this happens at exit too. Disabled, INSTRUMENT_SCOPE expands to nothing and dump()
+ * does nothing.
+ */
+#ifdef FSCOUT_INSTRUMENTATION
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace instrumentation {
+
+enum class Point : uint8_t {
+  CRAWL_DIRECTORY,
+  INSERT,
+  SEARCH,
+  SCORE,
+  RANK,
+  SERIALIZE,
+  DESERIALIZE,
+  UI_UPDATE,
+  NUM_POINTS
+};
+
+constexpr size_t NUM_POINTS = static_cast<size_t>(Point::NUM_POINTS);
+constexpr std::array<const char*, NUM_POINTS> POINT_NAMES = {
+  "crawl directory", "insert", "search", "score", "rank", "serialize", "deserialize", "ui update"};
+
+/*!
+ * \brief Durations in nanoseconds. Buckets split every power of two into 8, so values
+ * are exact below 16ns and 12.5% accurate above. Only the owning thread writes,
+ * every thread may read.
+ */
+class Histogram {
+ public:
+  static constexpr unsigned SUB_BUCKET_BITS = 3;
+  static constexpr size_t NUM_BUCKETS       = (64 - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+  using Counts                              = std::array<uint64_t, NUM_BUCKETS>;
+
+  void add(const uint64_t ns) {
+    increment(buckets[getBucket(ns)]);
+    increment(count);
+    if (ns > max.load(std::memory_order_relaxed)) {
+      max.store(ns, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+  uint64_t getMax() const { return max.load(std::memory_order_relaxed); }
+
+  void addCountsTo(Counts& counts) const {
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      counts[i] += buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  /*!
+   * \brief The lowest value of the bucket holding the given quantile.
+   */
+  static uint64_t getQuantile(const Counts& counts, const double quantile) {
+    uint64_t total = 0;
+    for (const uint64_t c : counts) {
+      total += c;
+    }
+    const auto rank = static_cast<uint64_t>(quantile * static_cast<double>(total));
+    uint64_t seen   = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      seen += counts[i];
+      if (seen > rank) {
+        return getLowerBound(i);
+      }
+    }
+    return 0;
+  }
+
+ private:
+  static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+
+  static size_t getBucket(const uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+      return static_cast<size_t>(value);
+    }
+    const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - SUB_BUCKET_BITS;
+    return static_cast<size_t>((uint64_t{shift} << SUB_BUCKET_BITS) + (value >> shift));
+  }
+
+  static uint64_t getLowerBound(const size_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) {
+      return bucket;
+    }
+    const size_t shift = (bucket >> SUB_BUCKET_BITS) - 1;
+    return (SUB_BUCKETS + (bucket & (SUB_BUCKETS - 1))) << shift;
+  }
+
+  // no read-modify-write needed, this thread is the only writer
+  static void increment(std::atomic<uint64_t>& value) {
+    value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets{};
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> max{0};
+};
+
+struct ThreadHistograms {
+  size_t threadIndex;
+  std::array<Histogram, NUM_POINTS> points;
+};
+
+/*!
+ * \brief Knows the histograms of all threads, they outlive their thread.
+ * Prints them when the program exits.
+ */
+class Registry {
+ public:
+  static Registry& get() {
+    static Registry registry;
+    return registry;
+  }
+
+  ~Registry() { dump(std::cerr); }
+
+  std::shared_ptr<ThreadHistograms> addThread() {
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.push_back(std::make_shared<ThreadHistograms>());
+    threads.back()->threadIndex = threads.size() - 1;
+    return threads.back();
+  }
+
+  void dump(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    out << "instrumentation (ns)           thread      count        p50        p99        max\n";
+    for (size_t point = 0; point < NUM_POINTS; ++point) {
+      for (const auto& thread : threads) {
+        const Histogram& histogram = thread->points[point];
+        if (histogram.getCount() == 0) {
+          continue;
+        }
+        Histogram::Counts counts{};
+        histogram.addCountsTo(counts);
+        out << std::left << std::setw(30) << POINT_NAMES[point] << std::right << std::setw(7)
+            << thread->threadIndex << std::setw(11) << histogram.getCount() << std::setw(11)
+            << Histogram::getQuantile(counts, 0.5) << std::setw(11)
+            << Histogram::getQuantile(counts, 0.99) << std::setw(11) << histogram.getMax()
+            << '\n';
+      }
+    }
+    out.flush();
+  }
+
+ private:
+  Registry() = default;
+
+  mutable std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadHistograms>> threads;
+};
+
+inline ThreadHistograms& getThreadHistograms() {
+  thread_local const std::shared_ptr<ThreadHistograms> histograms = Registry::get().addThread();
+  return *histograms;
+}
+
+class ScopedTimer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit ScopedTimer(const Point point)
+      : point(point),
+        start(Clock::now()) {}
+  ScopedTimer(const ScopedTimer&)            = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  ~ScopedTimer() {
+    const auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    getThreadHistograms().points[static_cast<size_t>(point)].add(static_cast<uint64_t>(ns));
+  }
+
+ private:
+  const Point point;
+  const Clock::time_point start;
+};
+
+inline void dump(std::ostream& out) { Registry::get().dump(out); }
+
+}  // namespace instrumentation
+
+#define INSTRUMENT_CONCAT_(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_(a, b)
+#define INSTRUMENT_SCOPE(point)                                                     \
+  const instrumentation::ScopedTimer INSTRUMENT_CONCAT(instrumentTimer_, __LINE__)( \
+    instrumentation::Point::point)
+
+#else
+
+namespace instrumentation {
+inline void dump(std::ostream&) {}
+}  // namespace instrumentation
+
+#define INSTRUMENT_SCOPE(point) static_cast<void>(0)
+
+#endif
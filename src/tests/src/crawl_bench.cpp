@@ -0,0 +1,173 @@
+// Crawl benchmark on a synthetic folder tree, see synthetic_tree.hpp.
+// The default tree is generated into /dev/shm (or the temp folder) and removed afterwards.
+// CRAWL_BENCH_ROOT crawls an existing tree instead, e.g. one made by generate_tree.
+#include "synthetic_tree.hpp"
+
+#include <finder/Finder.h>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <fstream>
+#endif
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+/*!
+ * \brief Index root with a fresh Finder, like the GUI does on a new root.
+ * The finder uses the default settings and writes nothing: no index cache, no settings
+ * of the user, which would also add their I/O to the numbers.
+ * \return The number of indexed entries.
+ */
+size_t crawl(const std::filesystem::path& root) {
+  auto finished = std::make_shared<std::promise<size_t>>();
+  auto future   = finished->get_future();
+  Finder finder(Finder::Persistence::READ_ONLY,
+                std::filesystem::temp_directory_path() / "fscout_crawl_bench_settings.txt");
+  finder.setRootPath(root, [&finder, finished](const bool success, const bool done, const std::wstring&) {
+    if (done) {
+      finished->set_value(success ? finder.getNumEntries() : 0);
+    }
+  });
+  return future.get();
+}
+
+#ifdef __linux__
+/*!
+ * \brief Counts the syscalls of this process and the threads it starts from now on.
+ * Needs access to the raw_syscalls tracepoint (root or perf_event_paranoid <= -1),
+ * isValid() is false otherwise.
+ */
+class SyscallCounter {
+ public:
+  SyscallCounter() {
+    std::ifstream idFile("/sys/kernel/tracing/events/raw_syscalls/sys_enter/id");
+    if (!idFile) {
+      idFile.open("/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id");
+    }
+    uint64_t id = 0;
+    if (!(idFile >> id)) {
+      return;
+    }
+    perf_event_attr attributes{};
+    attributes.type           = PERF_TYPE_TRACEPOINT;
+    attributes.size           = sizeof(attributes);
+    attributes.config         = id;
+    attributes.inherit        = 1;  // the crawl runs in a worker thread
+    attributes.exclude_kernel = 0;
+    fd = static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+  }
+  ~SyscallCounter() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+
+  bool isValid() const { return fd >= 0; }
+
+  /*!
+   * \brief Threads add their counts when they exit, so read after joining them.
+   */
+  uint64_t get() const {
+    uint64_t count = 0;
+    return ::read(fd, &count, sizeof(count)) == sizeof(count) ? count : 0;
+  }
+
+ private:
+  int fd = -1;
+};
+#endif
+
+/*!
+ * \brief Crawl once and print the cost per entry.
+ */
+size_t reportCrawl(const std::filesystem::path& root) {
+#ifdef __linux__
+  SyscallCounter syscalls;
+#endif
+#ifndef _WIN32
+  rusage before{};
+  ::getrusage(RUSAGE_SELF, &before);
+#endif
+  const auto start        = std::chrono::steady_clock::now();
+  const size_t numEntries = crawl(root);  // the finder joins its threads when destroyed
+  const double seconds =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const double entries = static_cast<double>(std::max<size_t>(numEntries, 1));
+
+  std::cout << numEntries << " entries in " << seconds * 1000 << " ms, "
+            << numEntries / seconds << " entries/s" << std::endl;
+#ifndef _WIN32
+  rusage after{};
+  ::getrusage(RUSAGE_SELF, &after);
+  auto micros = [](const timeval& time) { return time.tv_sec * 1e6 + time.tv_usec; };
+  std::cout << "per entry: " << (micros(after.ru_utime) - micros(before.ru_utime)) / entries
+            << " us user, " << (micros(after.ru_stime) - micros(before.ru_stime)) / entries
+            << " us system, " << (after.ru_minflt - before.ru_minflt) / entries
+            << " minor page faults, " << (after.ru_inblock - before.ru_inblock) / entries
+            << " block reads" << std::endl;
+  // kilobytes on linux, bytes on macOS
+#ifdef __APPLE__
+  std::cout << "peak RSS: " << after.ru_maxrss / (1024 * 1024) << " MB" << std::endl;
+#else
+  std::cout << "peak RSS: " << after.ru_maxrss / 1024 << " MB" << std::endl;
+#endif
+#endif
+#ifdef __linux__
+  if (syscalls.isValid()) {
+    std::cout << "per entry: " << syscalls.get() / entries << " syscalls" << std::endl;
+  } else {
+    std::cout << "syscalls not counted, the raw_syscalls tracepoint is not accessible"
+              << std::endl;
+  }
+#endif
+  return numEntries;
+}
+
+}  // namespace
+
+TEST_CASE("Crawl benchmark on a synthetic tree") {
+  std::filesystem::path root;
+  std::optional<synthetic::GeneratedTree> generated;
+  if (const char* existing = std::getenv("CRAWL_BENCH_ROOT")) {
+    root = existing;
+    REQUIRE(std::filesystem::is_directory(root));
+  } else {
+    // a tmpfs takes the disk out of the numbers
+    const std::filesystem::path scratch = std::filesystem::is_directory("/dev/shm")
+                                            ? std::filesystem::path("/dev/shm")
+                                            : std::filesystem::temp_directory_path();
+    root = scratch / "fscout_crawl_bench";
+    std::filesystem::remove_all(root);
+    generated = synthetic::generateTree(root, synthetic::TreeShape{});
+  }
+
+  const size_t numEntries = reportCrawl(root);
+  if (generated) {
+    // excluded folders are skipped and symlinks not followed
+    CHECK(numEntries == generated->getNumIndexable());
+  }
+
+  BENCHMARK("crawl " + std::to_string(numEntries) + " entries") { return crawl(root); };
+
+  if (generated) {
+    std::filesystem::remove_all(root);
+  }
+}
@@ -0,0 +1,234 @@
+// Benchmarks of the index on synthetic names, see synthetic_names.hpp.
+// Corpora of 10k, 100k and 1M entries run by default. Set FINDER_BENCH_MAX_ENTRIES
+// (e.g. to 10000000) for larger ones, they need a few GB of memory. The large corpora
+// take long with the default 100 samples, --benchmark-samples 10 is usually enough.
+#include "synthetic_names.hpp"
+
+#include <finder/Dictionary.h>
+#include <finder/Tree.h>
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utils/system/memory.hpp>
+#include <vector>
+
+namespace {
+
+constexpr size_t DEFAULT_MAX_ENTRIES = 1000000;
+constexpr uint32_t SEED              = 4711;
+// names of results scored per scoring benchmark
+constexpr size_t MAX_SCORED_NAMES = 10000;
+
+std::vector<size_t> getCorpusSizes() {
+  size_t maxEntries = DEFAULT_MAX_ENTRIES;
+  if (const char* max = std::getenv("FINDER_BENCH_MAX_ENTRIES")) {
+    maxEntries = std::strtoull(max, nullptr, 10);
+  }
+  std::vector<size_t> sizes;
+  for (size_t size = 10000; size <= maxEntries && size <= 10000000; size *= 10) {
+    sizes.push_back(size);
+  }
+  return sizes;
+}
+
+std::wstring toLower(std::wstring text) {
+  std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+  return text;
+}
+
+struct Corpus {
+  std::unique_ptr<Dictionary> dictionary;
+  // every name, lower case like the tree stores them
+  std::vector<std::wstring> names;
+  // bytes of the process per entry after building the dictionary
+  double memoryPerEntry = 0;
+};
+
+Corpus buildCorpus(const size_t numEntries) {
+  Corpus corpus;
+  const double memoryBefore = util::MemoryUsage::get(util::MemoryUnit::B);
+  corpus.dictionary         = std::make_unique<Dictionary>();
+  synthetic::generatePaths(
+    L"/synthetic", numEntries, SEED, [&](const std::filesystem::path& path, const bool isDirectory) {
+      corpus.dictionary->addPath(path, isDirectory);
+    });
+  corpus.dictionary->finalize(true);
+  corpus.memoryPerEntry =
+    (util::MemoryUsage::get(util::MemoryUnit::B) - memoryBefore) / static_cast<double>(numEntries);
+
+  corpus.names.reserve(numEntries);
+  synthetic::generatePaths(
+    L"/synthetic", numEntries, SEED, [&](const std::filesystem::path& path, const bool) {
+      corpus.names.push_back(toLower(path.filename().wstring()));
+    });
+  return corpus;
+}
+
+/*!
+ * \brief A name of the corpus long enough to cut every kind of query from it.
+ */
+std::wstring pickQueryName(const Corpus& corpus) {
+  for (size_t i = corpus.names.size() / 2; i < corpus.names.size(); ++i) {
+    if (corpus.names[i].size() >= 10) {
+      return corpus.names[i];
+    }
+  }
+  return corpus.names.back();
+}
+
+std::vector<EntryId> search(const Dictionary& dictionary,
+                            const std::wstring& needle,
+                            const size_t numFuzzyReplacements = 0,
+                            const wchar_t wildcard            = Dictionary::NO_WILDCARD) {
+  std::atomic<bool> stop = false;
+  std::vector<EntryId> matches;
+  dictionary.search(stop, needle, numFuzzyReplacements, wildcard, matches);
+  return matches;
+}
+
+std::vector<EntryId> searchBest(const Dictionary& dictionary,
+                                const std::wstring& needle,
+                                const size_t numFuzzyReplacements,
+                                const size_t maxResults) {
+  std::atomic<bool> stop = false;
+  std::vector<EntryId> matches;
+  dictionary.searchBest(stop,
+                        needle,
+                        numFuzzyReplacements,
+                        Dictionary::NO_WILDCARD,
+                        maxResults,
+                        [](EntryId, const std::wstring&) { return true; },
+                        matches);
+  return matches;
+}
+
+std::vector<EntryId> searchQuery(const Dictionary& dictionary, const Query& query) {
+  std::atomic<bool> stop = false;
+  std::vector<EntryId> matches;
+  dictionary.searchQuery(stop, query, Dictionary::NO_WILDCARD, matches);
+  return matches;
+}
+
+}  // namespace
+
+TEST_CASE("Finder benchmarks on synthetic names") {
+  for (const size_t size : getCorpusSizes()) {
+    const std::string entries    = std::to_string(size) + " entries";
+    const Corpus corpus          = buildCorpus(size);
+    const Dictionary& dictionary = *corpus.dictionary;
+
+    const auto file = std::filesystem::temp_directory_path() / "fscout_finder_bench.index";
+    REQUIRE(dictionary.serialize(file, std::chrono::steady_clock::now()));
+    const double diskPerEntry =
+      static_cast<double>(std::filesystem::file_size(file)) / static_cast<double>(size);
+    std::cout << entries << ": " << corpus.memoryPerEntry << " bytes/entry in memory ("
+              << dictionary.getStatistics().getBytesPerEntry() << " counted), " << diskPerEntry
+              << " bytes/entry on disk" << std::endl;
+
+    // every kind of query is cut from the same name, so each one finds at least that
+    const std::wstring name      = pickQueryName(corpus);
+    const std::wstring exact     = name;
+    const std::wstring prefix    = name.substr(0, 4);
+    const std::wstring substring = name.substr(name.size() / 2 - 2, 4);
+    std::wstring wildcard        = name.substr(0, 6);
+    wildcard[2]                  = L'*';
+    wildcard[4]                  = L'*';
+    std::wstring fuzzy           = name;
+    fuzzy[fuzzy.size() / 2]      = fuzzy[fuzzy.size() / 2] == L'q' ? L'x' : L'q';
+
+    REQUIRE_FALSE(search(dictionary, exact).empty());
+    REQUIRE_FALSE(search(dictionary, prefix).empty());
+    REQUIRE_FALSE(search(dictionary, substring).empty());
+    REQUIRE_FALSE(search(dictionary, wildcard, 0, L'*').empty());
+    REQUIRE_FALSE(search(dictionary, fuzzy, 1).empty());
+
+    BENCHMARK_ADVANCED("Tree::insertWord, " + entries)(Catch::Benchmark::Chronometer meter) {
+      meter.measure([&] {
+        Tree tree;
+        for (size_t i = 0; i < corpus.names.size(); ++i) {
+          tree.insertWord(corpus.names[i], static_cast<EntryId>(i));
+        }
+        return tree.getMaxEntryLength();
+      });
+    };
+
+    BENCHMARK("search exact, " + entries) { return search(dictionary, exact).size(); };
+    BENCHMARK("search prefix, " + entries) { return search(dictionary, prefix).size(); };
+    BENCHMARK("search substring, " + entries) { return search(dictionary, substring).size(); };
+    BENCHMARK("search wildcard, " + entries) {
+      return search(dictionary, wildcard, 0, L'*').size();
+    };
+    BENCHMARK("search fuzzy, " + entries) { return search(dictionary, fuzzy, 1).size(); };
+    // best-first, stops once the 20 best are certain
+    BENCHMARK("search best 20 substring, " + entries) {
+      return searchBest(dictionary, substring, 1, 20).size();
+    };
+    BENCHMARK("search best 20 fuzzy, " + entries) {
+      return searchBest(dictionary, fuzzy, 2, 20).size();
+    };
+    // the files of an extension come from their bitmap, with a term they are joined
+    const std::wstring extension = ExtensionIndex::getExtension(name);
+    if (!extension.empty()) {
+      const Query filter   = Query::parse(L"ext:" + extension, [](size_t) { return 0; });
+      const Query filtered = Query::parse(prefix + L" ext:" + extension, [](size_t) { return 0; });
+      REQUIRE_FALSE(searchQuery(dictionary, filter).empty());
+      REQUIRE_FALSE(searchQuery(dictionary, filtered).empty());
+      BENCHMARK("search extension filter, " + entries) {
+        return searchQuery(dictionary, filter).size();
+      };
+      BENCHMARK("search prefix with extension filter, " + entries) {
+        return searchQuery(dictionary, filtered).size();
+      };
+    }
+
+    // scoring runs on the results of a search, a short query gives plenty of them.
+    // The names are decoded beforehand.
+    const std::wstring shortQuery = name.substr(0, 2);
+    const auto shortMatches       = search(dictionary, shortQuery);
+    std::vector<std::wstring> resultNames;
+    for (size_t i = 0; i < shortMatches.size() && i < MAX_SCORED_NAMES; ++i) {
+      resultNames.push_back(dictionary.getName(shortMatches[i]));
+    }
+    const std::string scored = std::to_string(resultNames.size()) + " results, " + entries;
+    BENCHMARK("Dictionary::scoreMatch, " + scored) {
+      int total = 0;
+      for (const auto& resultName : resultNames) {
+        total += Dictionary::scoreMatch(shortQuery, resultName);
+      }
+      return total;
+    };
+    BENCHMARK_ADVANCED("Dictionary::getMatchScores, " + scored)
+    (Catch::Benchmark::Chronometer meter) {
+      std::vector<int> scores;
+      meter.measure([&] {
+        int total = 0;
+        for (const auto& resultName : resultNames) {
+          scores.resize(resultName.size());
+          Dictionary::getMatchScores(shortQuery, resultName, scores.data());
+          total += scores.front();
+        }
+        return total;
+      });
+    };
+
+    BENCHMARK("serialize, " + entries) {
+      return dictionary.serialize(file, std::chrono::steady_clock::now());
+    };
+    BENCHMARK("deserialize, " + entries) {
+      Dictionary loaded;
+      std::chrono::steady_clock::time_point time;
+      loaded.deserialize(file, &time);
+      return loaded.getSize();
+    };
+
+    std::filesystem::remove(file);
+  }
+}
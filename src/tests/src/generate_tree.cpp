@@ -0,0 +1,94 @@
+// Creates a synthetic folder tree to crawl, e.g. in a tmpfs:
+//   generate_tree --fan-out 10 --depth 5 /dev/shm/fscout_tree
+//   CRAWL_BENCH_ROOT=/dev/shm/fscout_tree crawl_bench
+#include "synthetic_tree.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+
+namespace {
+
+void printUsage(const char* name) {
+  const synthetic::TreeShape defaults;
+  std::cerr << "Usage: " << name << " [options] <new folder>\n"
+            << "\n"
+            << "  --fan-out <n>      sub folders per folder (default " << defaults.fanOut << ")\n"
+            << "  --depth <n>        levels of folders (default " << defaults.depth << ")\n"
+            << "  --files <n>        files per folder (default " << defaults.filesPerFolder
+            << ")\n"
+            << "  --hidden <ratio>   share of hidden names (default " << defaults.hiddenRatio
+            << ")\n"
+            << "  --cycles <n>       symlinks to an ancestor (default " << defaults.symlinkCycles
+            << ")\n"
+            << "  --excluded <n>     .git/.cache folders (default " << defaults.excludedFolders
+            << ")\n"
+            << "  --seed <n>         seed of the names (default " << defaults.seed << ")\n";
+}
+
+std::optional<std::pair<std::filesystem::path, synthetic::TreeShape>> parseArguments(int argc,
+                                                                                     char* argv[]) {
+  synthetic::TreeShape shape;
+  std::filesystem::path root;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg.size() > 2 && arg.starts_with("--")) {
+      if (i + 1 >= argc) {
+        return std::nullopt;
+      }
+      const char* value = argv[++i];
+      if (arg == "--fan-out") {
+        shape.fanOut = std::strtoull(value, nullptr, 10);
+      } else if (arg == "--depth") {
+        shape.depth = std::strtoull(value, nullptr, 10);
+      } else if (arg == "--files") {
+        shape.filesPerFolder = std::strtoull(value, nullptr, 10);
+      } else if (arg == "--hidden") {
+        shape.hiddenRatio = std::strtod(value, nullptr);
+      } else if (arg == "--cycles") {
+        shape.symlinkCycles = std::strtoull(value, nullptr, 10);
+      } else if (arg == "--excluded") {
+        shape.excludedFolders = std::strtoull(value, nullptr, 10);
+      } else if (arg == "--seed") {
+        shape.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+      } else {
+        return std::nullopt;
+      }
+    } else if (root.empty()) {
+      root = arg;
+    } else {
+      return std::nullopt;
+    }
+  }
+  if (root.empty()) {
+    return std::nullopt;
+  }
+  return std::make_pair(root, shape);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const auto arguments = parseArguments(argc, argv);
+  if (!arguments) {
+    printUsage(argv[0]);
+    return 2;
+  }
+  const auto& [root, shape] = *arguments;
+  if (std::filesystem::exists(root)) {
+    std::cerr << root.string() << " exists already" << std::endl;
+    return 1;
+  }
+
+  try {
+    const synthetic::GeneratedTree tree = synthetic::generateTree(root, shape);
+    std::cout << tree.numFolders << " folders, " << tree.numFiles << " files, "
+              << tree.numSymlinks << " symlinks, " << tree.numExcluded << " excluded entries, "
+              << tree.getNumIndexable() << " entries to index" << std::endl;
+  } catch (const std::filesystem::filesystem_error& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cwctype>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace synthetic {
+
+/*!
+ * \brief Reproducible file names which look like real ones: words with english letter
+ * frequencies, joined by '_', '-', '.' or camel case, sometimes numbered and mostly with
+ * an extension. Lengths are spread like in a home folder, from 2 to about 40 characters.
+ *
+ * Only std::mt19937 itself is used, the std distributions are implementation defined
+ * and would give other names with another standard library.
+ */
+class NameGenerator {
+ public:
+  explicit NameGenerator(const uint32_t seed)
+      : random(seed) {}
+
+  std::wstring next(const bool isDirectory = false) {
+    std::wstring name;
+    const uint32_t numWords = 1 + below(3) + (below(4) == 0 ? below(3) : 0);
+    const wchar_t separator = SEPARATORS[below(SEPARATORS.size())];
+    for (uint32_t i = 0; i < numWords; ++i) {
+      if (i > 0 && separator != L'A') {
+        name += separator;
+      }
+      std::wstring word = nextWord();
+      if ((i > 0 && separator == L'A') || below(20) == 0) {
+        word[0] = static_cast<wchar_t>(std::towupper(word[0]));
+      }
+      name += word;
+    }
+    if (below(5) == 0) {
+      name += std::to_wstring(below(below(2) == 0 ? 10 : 2030));
+    }
+    if (!isDirectory && below(10) != 0) {
+      name += L'.';
+      name += EXTENSIONS[below(below(2) == 0 ? 4 : EXTENSIONS.size())];
+    }
+    return name;
+  }
+
+  uint32_t below(const size_t n) { return static_cast<uint32_t>(random() % n); }
+
+ private:
+  // 'A' joins the words camel case
+  static constexpr std::array<wchar_t, 6> SEPARATORS = {L'_', L'_', L'-', L'.', L'A', L'A'};
+  static constexpr std::array<const wchar_t*, 24> EXTENSIONS = {
+    L"txt", L"jpg", L"cpp", L"h",    L"png", L"pdf", L"py",  L"json",
+    L"md",  L"so",  L"xml", L"html", L"js",  L"mp3", L"mp4", L"zip",
+    L"gz",  L"csv", L"log", L"conf", L"svg", L"doc", L"o",   L"hpp"};
+  // relative frequency of 'a' to 'z' in english text, per mille
+  static constexpr std::array<uint32_t, 26> LETTER_FREQUENCIES = {
+    82, 15, 28, 43, 127, 22, 20, 61, 70, 2, 8, 40, 24, 67, 75, 19, 1, 60, 63, 91, 28, 10, 24, 2, 20, 1};
+
+  wchar_t letter() {
+    uint32_t pick = below(1003);  // sum of the frequencies
+    for (size_t i = 0; i < LETTER_FREQUENCIES.size(); ++i) {
+      if (pick < LETTER_FREQUENCIES[i]) {
+        return static_cast<wchar_t>(L'a' + i);
+      }
+      pick -= LETTER_FREQUENCIES[i];
+    }
+    return L'e';
+  }
+
+  std::wstring nextWord() {
+    // mostly short words, few long ones
+    const uint32_t length = 2 + below(4) + below(4) + (below(6) == 0 ? below(8) : 0);
+    std::wstring word(length, L' ');
+    for (auto& c : word) {
+      c = letter();
+    }
+    return word;
+  }
+
+  std::mt19937 random;
+};
+
+/*!
+ * \brief Call add(path, isDirectory) for numEntries entries below root, parents first.
+ * About every tenth entry is a folder, the entries gather in recently created folders
+ * up to maxDepth levels deep, like the files of a project stay together.
+ */
+template <class Add>
+void generatePaths(const std::filesystem::path& root,
+                   const size_t numEntries,
+                   const uint32_t seed,
+                   Add&& add,
+                   const size_t maxDepth = 8) {
+  struct Folder {
+    std::filesystem::path path;
+    size_t depth;
+  };
+  NameGenerator names(seed);
+  std::vector<Folder> folders{{root, 0}};
+  for (size_t i = 0; i < numEntries; ++i) {
+    const size_t recent = std::min<size_t>(folders.size(), 64);
+    const Folder& parent = folders[folders.size() - 1 - names.below(recent)];
+    const bool isDirectory = names.below(10) == 0 && parent.depth < maxDepth;
+    std::filesystem::path path = parent.path / names.next(isDirectory);
+    add(path, isDirectory);
+    if (isDirectory) {
+      folders.push_back({std::move(path), parent.depth + 1});
+    }
+  }
+}
+
+}  // namespace synthetic
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "synthetic_names.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace synthetic {
+
+/*!
+ * \brief The shape of a generated folder tree.
+ */
+struct TreeShape {
+  // sub folders of every folder above maxDepth
+  size_t fanOut = 8;
+  // levels of folders below the root
+  size_t depth = 4;
+  size_t filesPerFolder = 16;
+  // share of the files and folders whose name starts with a dot
+  double hiddenRatio = 0.05;
+  // symlinks to an ancestor folder, a crawler following them never ends
+  size_t symlinkCycles = 16;
+  // folders named like a default exception (.git, .cache), each with filesPerFolder files
+  size_t excludedFolders = 16;
+  uint32_t seed = 1;
+};
+
+struct GeneratedTree {
+  size_t numFolders  = 0;
+  size_t numFiles    = 0;
+  size_t numSymlinks = 0;
+  // entries in or of excluded folders
+  size_t numExcluded = 0;
+
+  /*!
+   * \brief The entries a crawler should index: everything but the excluded folders,
+   * symlinks count as entries but are not followed.
+   */
+  size_t getNumIndexable() const { return numFolders + numFiles + numSymlinks; }
+};
+
+/*!
+ * \brief Create the tree below root, which must not exist yet. The same shape gives
+ * the same tree. Throws std::filesystem::filesystem_error if it can not be written.
+ */
+inline GeneratedTree generateTree(const std::filesystem::path& root, const TreeShape& shape) {
+  NameGenerator names(shape.seed);
+  GeneratedTree tree;
+
+  // a folder must not contain a name twice
+  auto uniqueName = [&](std::unordered_set<std::wstring>& used, const bool isDirectory) {
+    std::wstring name = names.next(isDirectory);
+    if (names.below(1000) < shape.hiddenRatio * 1000) {
+      name = L'.' + name;
+    }
+    while (!used.insert(name).second) {
+      name += L'_';
+    }
+    return name;
+  };
+  auto createFiles = [&](const std::filesystem::path& folder,
+                         std::unordered_set<std::wstring>& used) {
+    for (size_t i = 0; i < shape.filesPerFolder; ++i) {
+      std::ofstream(folder / uniqueName(used, false));
+    }
+  };
+
+  std::filesystem::create_directories(root);
+  std::vector<std::filesystem::path> level{root};
+  std::vector<std::filesystem::path> folders;
+  for (size_t depth = 0; depth <= shape.depth; ++depth) {
+    std::vector<std::filesystem::path> nextLevel;
+    for (const auto& folder : level) {
+      std::unordered_set<std::wstring> used;
+      createFiles(folder, used);
+      tree.numFiles += shape.filesPerFolder;
+      if (depth == shape.depth) {
+        continue;
+      }
+      for (size_t i = 0; i < shape.fanOut; ++i) {
+        nextLevel.push_back(folder / uniqueName(used, true));
+        std::filesystem::create_directory(nextLevel.back());
+        ++tree.numFolders;
+      }
+    }
+    folders.insert(folders.end(), level.begin(), level.end());
+    level = std::move(nextLevel);
+  }
+
+  // spread over the whole tree, the root itself gets none
+  constexpr std::array<const wchar_t*, 2> EXCLUDED_NAMES = {L".git", L".cache"};
+  for (size_t i = 0; i < shape.excludedFolders && folders.size() > 1; ++i) {
+    const auto& parent = folders[1 + names.below(folders.size() - 1)];
+    const auto folder  = parent / EXCLUDED_NAMES[i % EXCLUDED_NAMES.size()];
+    if (!std::filesystem::create_directory(folder)) {
+      continue;  // the parent has one already
+    }
+    std::unordered_set<std::wstring> used;
+    createFiles(folder, used);
+    tree.numExcluded += 1 + shape.filesPerFolder;
+  }
+
+  for (size_t i = 0; i < shape.symlinkCycles && folders.size() > 1; ++i) {
+    const auto& folder = folders[1 + names.below(folders.size() - 1)];
+    // any ancestor, the root included
+    auto target = folder;
+    for (uint32_t up = names.below(shape.depth) + 1; up > 0 && target != root; --up) {
+      target = target.parent_path();
+    }
+    std::filesystem::create_directory_symlink(target, folder / (L"cycle_" + std::to_wstring(i)));
+    ++tree.numSymlinks;
+  }
+  return tree;
+}
+
+}  // namespace synthetic
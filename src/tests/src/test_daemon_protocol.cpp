@@ -0,0 +1,158 @@
+#include <finder/DaemonProtocol.h>
+#include <finder/Dictionary.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::shared_ptr<const Dictionary> makeDictionary(std::vector<EntryId>& ids) {
+  auto dictionary = std::make_shared<Dictionary>();
+  for (int i = 0; i < 100; ++i) {
+    ids.push_back(dictionary->addPath(L"/data/folder/file_" + std::to_wstring(i) + L".txt", false));
+  }
+  dictionary->finalize(true);
+  return dictionary;
+}
+
+std::vector<std::string> getPaths(const Dictionary& dictionary, const std::vector<EntryId>& ids) {
+  std::vector<std::string> paths;
+  for (const EntryId id : ids) {
+    const std::u8string utf8 = dictionary.getPath(id).u8string();
+    paths.emplace_back(utf8.begin(), utf8.end());
+  }
+  return paths;
+}
+
+std::vector<BinaryWriter> writeAll(const SearchResult& results,
+                                   const bool reset,
+                                   const size_t maxMessageSize) {
+  std::vector<BinaryWriter> messages;
+  REQUIRE(writeResults(
+    results,
+    reset,
+    [&](const BinaryWriter& message) {
+      messages.push_back(message);
+      return true;
+    },
+    maxMessageSize));
+  return messages;
+}
+
+// what the client does with the messages, true if the last one was finished
+bool readAll(const std::vector<BinaryWriter>& messages, std::vector<std::string>& shownPaths) {
+  bool finished = false;
+  for (const BinaryWriter& message : messages) {
+    CHECK_FALSE(finished);  // nothing follows the finished results
+    BinaryReader reader(message.getBuffer().data(), message.size());
+    REQUIRE(readDaemonMessageType(reader) == DaemonMessage::RESULTS);
+    finished = readResults(reader, shownPaths);
+  }
+  return finished;
+}
+
+}  // namespace
+
+TEST_CASE("Search requests are read as written") {
+  BinaryWriter writer;
+  writeSearchRequest(writer, L"/home/user", L"needle ext:h");
+  BinaryReader reader(writer.getBuffer().data(), writer.size());
+  REQUIRE(readDaemonMessageType(reader) == DaemonMessage::SEARCH);
+  std::filesystem::path root;
+  std::wstring needle;
+  readSearchRequest(reader, root, needle);
+  CHECK(root == std::filesystem::path(L"/home/user"));
+  CHECK(needle == L"needle ext:h");
+
+  SECTION("another protocol version is rejected") {
+    BinaryWriter other;
+    other.writePod(static_cast<uint8_t>(DaemonMessage::SEARCH));
+    other.writeVarint(DAEMON_PROTOCOL_VERSION + 1);
+    other.writeString("/");
+    other.writeString("x");
+    BinaryReader otherReader(other.getBuffer().data(), other.size());
+    readDaemonMessageType(otherReader);
+    CHECK_THROWS_AS(readSearchRequest(otherReader, root, needle), std::runtime_error);
+  }
+
+  SECTION("unknown messages are rejected") {
+    const char unknown = 42;
+    BinaryReader unknownReader(&unknown, 1);
+    CHECK_THROWS_AS(readDaemonMessageType(unknownReader), std::runtime_error);
+  }
+}
+
+TEST_CASE("Results are read as written") {
+  std::vector<EntryId> ids;
+  const auto dictionary = makeDictionary(ids);
+
+  SearchResult first;
+  first.finished       = true;
+  first.dictionary     = dictionary;
+  first.update.version = 1;
+  first.update.ranking.assign(ids.begin(), ids.begin() + 60);
+
+  SearchResult second;
+  second.finished           = true;
+  second.dictionary         = dictionary;
+  second.update.version     = 2;
+  second.update.baseVersion = 1;
+  second.update.reset       = false;
+  second.update.ranking.assign(ids.begin() + 20, ids.end());
+  std::swap(second.update.ranking[0], second.update.ranking[30]);
+  REQUIRE(diffResults(first.update.ranking, second.update.ranking, 1000, second.update.changes));
+
+  for (const size_t maxMessageSize : {MAX_RESULTS_MESSAGE_SIZE, size_t(256)}) {
+    std::vector<std::string> shownPaths = {"/left/over"};
+    const auto reset                    = writeAll(first, true, maxMessageSize);
+    CHECK(readAll(reset, shownPaths));
+    CHECK(shownPaths == getPaths(*dictionary, first.update.ranking));
+
+    const auto changes = writeAll(second, false, maxMessageSize);
+    CHECK(readAll(changes, shownPaths));
+    CHECK(shownPaths == getPaths(*dictionary, second.update.ranking));
+
+    if (maxMessageSize == MAX_RESULTS_MESSAGE_SIZE) {
+      CHECK(reset.size() == 1);
+      CHECK(changes.size() == 1);
+    } else {
+      // large results are split, no message grows beyond the limit by more than a path
+      CHECK(reset.size() > 1);
+      CHECK(changes.size() > 1);
+      for (const auto& message : reset) {
+        CHECK(message.size() <= maxMessageSize + 64);
+      }
+    }
+  }
+
+  SECTION("partial results are not finished") {
+    first.finished = false;
+    std::vector<std::string> shownPaths;
+    CHECK_FALSE(readAll(writeAll(first, true, 256), shownPaths));
+  }
+
+  SECTION("changes which do not fit the shown paths are rejected") {
+    std::vector<std::string> shownPaths = {"/only/one"};
+    const auto changes                  = writeAll(second, false, MAX_RESULTS_MESSAGE_SIZE);
+    CHECK_THROWS_AS(readAll(changes, shownPaths), std::runtime_error);
+  }
+
+  SECTION("a failed send stops writing") {
+    size_t sent = 0;
+    CHECK_FALSE(writeResults(
+      first, true, [&](const BinaryWriter&) { return ++sent < 2; }, 256));
+    CHECK(sent == 2);
+  }
+}
+
+TEST_CASE("Errors are read as written") {
+  BinaryWriter writer;
+  writeError(writer, "Not a folder: /nowhere");
+  BinaryReader reader(writer.getBuffer().data(), writer.size());
+  REQUIRE(readDaemonMessageType(reader) == DaemonMessage::ERROR);
+  CHECK(readError(reader) == "Not a folder: /nowhere");
+}
@@ -0,0 +1,130 @@
+#include <finder/EntryBitmap.h>
+#include <finder/ExtensionIndex.h>
+#include <finder/Query.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<EntryId> getIds(const EntryBitmap& bitmap) {
+  std::vector<EntryId> ids;
+  bitmap.forEach([&ids](const EntryId id) { ids.push_back(id); });
+  return ids;
+}
+
+EntryBitmap makeBitmap(const std::set<EntryId>& ids) {
+  EntryBitmap bitmap;
+  for (const EntryId id : ids) {
+    bitmap.add(id);
+  }
+  return bitmap;
+}
+
+}  // namespace
+
+TEST_CASE("Entry bitmaps hold sets of ids") {
+  EntryBitmap bitmap;
+  CHECK(bitmap.empty());
+  CHECK(bitmap.count() == 0);
+  CHECK_FALSE(bitmap.contains(0));
+
+  // out of order, on word boundaries and twice
+  for (const EntryId id : {EntryId{200}, EntryId{0}, EntryId{63}, EntryId{64}, EntryId{0}}) {
+    bitmap.add(id);
+  }
+  CHECK(getIds(bitmap) == std::vector<EntryId>{0, 63, 64, 200});
+  CHECK(bitmap.count() == 4);
+  CHECK(bitmap.contains(63));
+  CHECK(bitmap.contains(64));
+  CHECK_FALSE(bitmap.contains(65));
+  CHECK_FALSE(bitmap.contains(100000));
+
+  SECTION("random sets") {
+    std::mt19937 random(11);
+    for (int i = 0; i < 50; ++i) {
+      std::set<EntryId> a;
+      std::set<EntryId> b;
+      for (int j = random() % 500; j > 0; --j) {
+        a.insert(random() % 5000);
+      }
+      for (int j = random() % 500; j > 0; --j) {
+        b.insert(random() % 5000);
+      }
+      EntryBitmap merged      = makeBitmap(a);
+      const EntryBitmap other = makeBitmap(b);
+
+      size_t both = 0;
+      for (const EntryId id : a) {
+        both += b.count(id);
+      }
+      CHECK(merged.countIntersection(other) == both);
+      CHECK(other.countIntersection(merged) == both);
+
+      merged |= other;
+      std::set<EntryId> expected = a;
+      expected.insert(b.begin(), b.end());
+      CHECK(getIds(merged) == std::vector<EntryId>(expected.begin(), expected.end()));
+      CHECK(merged.count() == expected.size());
+    }
+  }
+}
+
+TEST_CASE("Extensions are the suffix after the last dot") {
+  CHECK(ExtensionIndex::getExtension(L"tree.cpp") == L"cpp");
+  CHECK(ExtensionIndex::getExtension(L"archive.tar.gz") == L"gz");
+  CHECK(ExtensionIndex::getExtension(L"makefile").empty());
+  CHECK(ExtensionIndex::getExtension(L".bashrc").empty());
+  CHECK(ExtensionIndex::getExtension(L"trailing.").empty());
+  CHECK(ExtensionIndex::getExtension(L"backup.2024-01-01_complete").empty());
+}
+
+TEST_CASE("The extension index finds and counts the files of an extension") {
+  ExtensionIndex index;
+  const std::vector<std::wstring> names = {
+    L"a.cpp", L"b.h", L"c.cpp", L"readme", L"d.h", L"e.cpp", L".hidden", L"f.txt"};
+  for (EntryId id = 0; id < names.size(); ++id) {
+    index.add(id, names[id]);
+  }
+  CHECK(index.size() == 3);
+
+  CHECK(getIds(index.getEntries({L"cpp"})) == std::vector<EntryId>{0, 2, 5});
+  // with a dot and in any case, unknown extensions add nothing
+  CHECK(getIds(index.getEntries({L".H", L"cpp", L"java"})) ==
+        std::vector<EntryId>{0, 1, 2, 4, 5});
+  CHECK(index.getEntries({}).empty());
+
+  SECTION("facet counts of a result set, the most common first") {
+    const EntryBitmap results                = makeBitmap({0, 1, 2, 3, 4, 7});
+    const std::vector<ExtensionCount> counts = index.countExtensions(results, 10);
+    REQUIRE(counts.size() == 3);
+    CHECK(counts[0].extension == L"cpp");
+    CHECK(counts[0].count == 2);
+    // the same count: by name
+    CHECK(counts[1].extension == L"h");
+    CHECK(counts[1].count == 2);
+    CHECK(counts[2].extension == L"txt");
+    CHECK(counts[2].count == 1);
+
+    const std::vector<ExtensionCount> top = index.countExtensions(results, 1);
+    REQUIRE(top.size() == 1);
+    CHECK(top[0].extension == L"cpp");
+    CHECK(index.countExtensions(EntryBitmap(), 10).empty());
+  }
+}
+
+TEST_CASE("Extension filters are parsed from the query") {
+  const auto noFuzzy = [](const size_t) { return size_t(0); };
+  const Query query  = Query::parse(L"tree ext:CPP,.h *.txt", noFuzzy);
+  REQUIRE(query.terms.size() == 1);
+  CHECK(query.terms[0][0].needle == L"tree");
+  CHECK(query.extensions == std::vector<std::wstring>{L"cpp", L"h", L"txt"});
+
+  // globs which are no plain extension are searched as names
+  const Query glob = Query::parse(L"*.tar.* *.", noFuzzy);
+  CHECK(glob.extensions.empty());
+  CHECK(glob.terms.size() == 2);
+}
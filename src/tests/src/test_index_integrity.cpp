@@ -0,0 +1,129 @@
+#include <finder/Crc32c.h>
+#include <finder/Dictionary.h>
+#include <finder/IndexFile.h>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::filesystem::path makeIndexFile(const std::string& name, const size_t numEntries) {
+  Dictionary dictionary;
+  const std::filesystem::path base = L"/synthetic";
+  for (size_t i = 0; i < numEntries; ++i) {
+    const std::filesystem::path folder =
+      base / (L"folder_" + std::to_wstring(i / 1000)) / (L"sub_" + std::to_wstring(i / 50));
+    if (i % 50 == 0) {
+      dictionary.addPath(folder, true);
+    }
+    dictionary.addPath(folder / (L"file_" + std::to_wstring(i) + L".txt"), false);
+  }
+  dictionary.finalize(true);
+
+  const auto file = std::filesystem::temp_directory_path() / name;
+  REQUIRE(dictionary.serialize(file, std::chrono::steady_clock::now()));
+  return file;
+}
+
+std::vector<char> readFile(const std::filesystem::path& file) {
+  std::ifstream in(file, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(in), {});
+}
+
+void writeFile(const std::filesystem::path& file, const std::vector<char>& data) {
+  std::ofstream out(file, std::ios::binary);
+  out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+bool loads(const std::filesystem::path& file, const IndexValidation validation) {
+  try {
+    Dictionary dictionary;
+    std::chrono::steady_clock::time_point time;
+    dictionary.deserialize(file, &time, validation);
+    return true;
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+}
+
+}  // namespace
+
+TEST_CASE("CRC32C") {
+  const std::string check = "123456789";
+  CHECK(crc32c(check.data(), check.size()) == 0xE3069283);
+  CHECK(crc32cSoftware(check.data(), check.size()) == 0xE3069283);
+
+  std::mt19937 random(42);
+  std::vector<char> data(100000);
+  for (auto& c : data) {
+    c = static_cast<char>(random());
+  }
+  for (const size_t size : {0, 1, 7, 8, 9, 63, 4096, 99999}) {
+    const uint32_t whole = crc32c(data.data(), size);
+    CHECK(whole == crc32cSoftware(data.data(), size));
+    // checksums can be continued chunk by chunk
+    CHECK(whole == crc32c(data.data() + size / 3, size - size / 3, crc32c(data.data(), size / 3)));
+  }
+}
+
+TEST_CASE("Corrupted index files are rejected") {
+  const auto file      = makeIndexFile("fscout_test_integrity.index", 20000);
+  const auto corrupted = std::filesystem::temp_directory_path() / "fscout_test_corrupted.index";
+  const auto original  = readFile(file);
+
+  REQUIRE(IndexFileReader::validate(file, IndexValidation::FULL));
+  REQUIRE(loads(file, IndexValidation::FULL));
+
+  SECTION("Truncated files are rejected by the header check") {
+    for (const size_t size : {size_t{0}, size_t{10}, original.size() / 2, original.size() - 1}) {
+      writeFile(corrupted, std::vector<char>(original.begin(), original.begin() + size));
+      CHECK_FALSE(IndexFileReader::validate(corrupted, IndexValidation::HEADER_ONLY));
+      CHECK_FALSE(loads(corrupted, IndexValidation::HEADER_ONLY));
+    }
+  }
+
+  SECTION("Flipped bits are caught by the checksums") {
+    std::mt19937 random(7);
+    for (int i = 0; i < 100; ++i) {
+      auto data = original;
+      data[random() % data.size()] ^= static_cast<char>(1 << (random() % 8));
+      writeFile(corrupted, data);
+      CHECK_FALSE(IndexFileReader::validate(corrupted, IndexValidation::FULL));
+      CHECK_FALSE(loads(corrupted, IndexValidation::FULL));
+      // without checksums the parser must still not crash, whatever it returns
+      loads(corrupted, IndexValidation::HEADER_ONLY);
+    }
+  }
+
+  std::filesystem::remove(corrupted);
+  std::filesystem::remove(file);
+}
+
+// hidden: builds a 1M entry index, too slow for ctest. Run with "[benchmark]".
+TEST_CASE("Index validation throughput", "[.][benchmark]") {
+  std::vector<char> data(64 << 20);
+  std::mt19937 random(1);
+  for (auto& c : data) {
+    c = static_cast<char>(random());
+  }
+  const auto file = makeIndexFile("fscout_bench_integrity.index", 1000000);
+
+  BENCHMARK("crc32c 64MB") { return crc32c(data.data(), data.size()); };
+  BENCHMARK("crc32c software 64MB") { return crc32cSoftware(data.data(), data.size()); };
+  BENCHMARK("validate header only, 1M entries") {
+    return IndexFileReader::validate(file, IndexValidation::HEADER_ONLY);
+  };
+  BENCHMARK("validate full, 1M entries") {
+    return IndexFileReader::validate(file, IndexValidation::FULL);
+  };
+  BENCHMARK("load header only, 1M entries") { return loads(file, IndexValidation::HEADER_ONLY); };
+  BENCHMARK("load full, 1M entries") { return loads(file, IndexValidation::FULL); };
+
+  std::filesystem::remove(file);
+}
@@ -0,0 +1,161 @@
+#include <finder/Dictionary.h>
+#include <finder/MetadataColumns.h>
+#include <finder/Query.h>
+
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+MetadataColumns readColumns(const BinaryWriter& writer, const size_t numEntries) {
+  BinaryReader reader(writer.getBuffer().data(), writer.size());
+  MetadataColumns columns;
+  columns.deserialize(reader, numEntries);
+  return columns;
+}
+
+Query parseQuery(const std::wstring& text) {
+  return Query::parse(text, [](const size_t) { return size_t(0); });
+}
+
+int64_t getNow() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+           std::chrono::system_clock::now().time_since_epoch())
+    .count();
+}
+
+}  // namespace
+
+TEST_CASE("Metadata columns are read as written") {
+  constexpr int64_t MIN_TIME = std::numeric_limits<int64_t>::min() + 1;
+  constexpr int64_t MAX_TIME = std::numeric_limits<int64_t>::max();
+  // times going back and forth, unknown ones and the extremes of the deltas
+  const std::vector<EntryMetadata> entries = {{0, 1700000000},
+                                              {4096, 1700000100},
+                                              {1, 1600000000},
+                                              {std::numeric_limits<uint64_t>::max(), -5},
+                                              {0, EntryMetadata::UNKNOWN_TIME},
+                                              {7, MAX_TIME},
+                                              {8, MIN_TIME},
+                                              {9, 0}};
+  MetadataColumns columns;
+  CHECK(columns.empty());
+  // entry 0 is left out, it gets the defaults
+  for (EntryId id = 1; id < entries.size(); ++id) {
+    columns.set(id, entries[id]);
+  }
+  CHECK(columns.get(0).size == 0);
+  CHECK(columns.get(0).modificationTime == EntryMetadata::UNKNOWN_TIME);
+  // beyond the columns
+  CHECK(columns.get(100).modificationTime == EntryMetadata::UNKNOWN_TIME);
+
+  BinaryWriter writer;
+  columns.serialize(writer);
+  const MetadataColumns read = readColumns(writer, entries.size());
+  for (EntryId id = 1; id < entries.size(); ++id) {
+    CHECK(read.get(id).size == entries[id].size);
+    CHECK(read.get(id).modificationTime == entries[id].modificationTime);
+  }
+
+  SECTION("more metadata than entries is rejected") {
+    CHECK_THROWS_AS(readColumns(writer, entries.size() - 1), std::runtime_error);
+  }
+
+  SECTION("no metadata") {
+    BinaryWriter empty;
+    MetadataColumns().serialize(empty);
+    CHECK(readColumns(empty, 10).empty());
+  }
+}
+
+TEST_CASE("Metadata filters check sizes and times") {
+  MetadataFilter filter;
+  CHECK_FALSE(filter.isActive());
+  CHECK(filter.accepts(EntryMetadata(), true));
+
+  filter.minSize = 100;
+  CHECK(filter.isActive());
+  CHECK(filter.accepts({100, 0}, false));
+  CHECK_FALSE(filter.accepts({99, 0}, false));
+  // folders have no size
+  CHECK_FALSE(filter.accepts({1000, 0}, true));
+
+  MetadataFilter recent;
+  recent.minModificationTime = 1000;
+  CHECK(recent.accepts({0, 1000}, true));
+  CHECK_FALSE(recent.accepts({0, 999}, false));
+  CHECK_FALSE(recent.accepts({0, EntryMetadata::UNKNOWN_TIME}, false));
+}
+
+TEST_CASE("Size, time and sort terms are parsed from the query") {
+  constexpr uint64_t KIB = 1024;
+  constexpr int64_t DAY  = 24 * 3600;
+
+  const Query sizes = parseQuery(L"log size:>1.5k size:<=2MB");
+  REQUIRE(sizes.terms.size() == 1);
+  CHECK(sizes.metadata.minSize == 3 * KIB / 2);
+  CHECK(sizes.metadata.maxSize == 2 * KIB * KIB);
+  CHECK(sizes.sortKey == Query::SortKey::SCORE);
+
+  const int64_t before = getNow();
+  const Query times    = parseQuery(L"modified:<7d modified:>2 sort:modified");
+  const int64_t after  = getNow();
+  CHECK(times.terms.empty());
+  // changed within the last week, but not within the last two days
+  CHECK(times.metadata.minModificationTime >= before - 7 * DAY);
+  CHECK(times.metadata.minModificationTime <= after - 7 * DAY);
+  CHECK(times.metadata.maxModificationTime >= before - 2 * DAY);
+  CHECK(times.metadata.maxModificationTime <= after - 2 * DAY);
+  CHECK(times.sortKey == Query::SortKey::MODIFICATION_TIME);
+  CHECK(parseQuery(L"sort:size").sortKey == Query::SortKey::SIZE);
+  CHECK(parseQuery(L"sort:size sort:score").sortKey == Query::SortKey::SCORE);
+
+  SECTION("terms which do not parse are searched as names") {
+    const Query invalid = parseQuery(L"size:>abc size:100 modified:<7x sort:name size:>-1");
+    CHECK_FALSE(invalid.metadata.isActive());
+    CHECK(invalid.sortKey == Query::SortKey::SCORE);
+    CHECK(invalid.terms.size() == 5);
+  }
+}
+
+TEST_CASE("Queries of only metadata filters keep to the search budget") {
+  constexpr size_t NUM_FILES = 2000;
+  Dictionary dictionary;
+  dictionary.addPath(L"/data", true);
+  for (size_t i = 0; i < NUM_FILES; ++i) {
+    const EntryId id = dictionary.addPath(L"/data/file_" + std::to_wstring(i) + L".bin", false);
+    dictionary.setMetadata(id, {i, 1700000000});
+  }
+  dictionary.finalize(true);
+  const Query query = parseQuery(L"size:>=1000");
+
+  std::atomic<bool> stop = false;
+  std::vector<EntryId> matches;
+  SearchProgress progress = dictionary.searchQuery(stop, query, Dictionary::NO_WILDCARD, matches);
+  CHECK(progress.complete);
+  CHECK(matches.size() == NUM_FILES - 1000);
+
+  SECTION("the scanned entries count as visited nodes") {
+    SearchBudget budget;
+    budget.maxNodesVisited = NUM_FILES / 2;
+    matches.clear();
+    progress = dictionary.searchQuery(stop, query, Dictionary::NO_WILDCARD, matches, budget);
+    CHECK_FALSE(progress.complete);
+    CHECK(matches.size() < NUM_FILES - 1000);
+  }
+
+  SECTION("a passed deadline stops the scan") {
+    SearchBudget budget;
+    budget.deadline = SearchBudget::Clock::now() - std::chrono::seconds(1);
+    matches.clear();
+    progress = dictionary.searchQuery(stop, query, Dictionary::NO_WILDCARD, matches, budget);
+    CHECK_FALSE(progress.complete);
+    CHECK(matches.size() < NUM_FILES - 1000);
+  }
+}
@@ -0,0 +1,140 @@
+#include <finder/Finder.h>
+#include <finder/OpenHistory.h>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr int64_t DAY   = 24 * 3600;
+constexpr int64_t START = 1700000000;
+
+double getOpens(const OpenHistory& history, const std::filesystem::path& path, const int64_t now) {
+  return history.getOpens(path.filename().wstring(), [&path]() { return path; }, now);
+}
+
+}  // namespace
+
+TEST_CASE("Opens count one each and decay with their half life") {
+  OpenHistory history;
+  CHECK(history.empty());
+  CHECK(history.getMaxOpens(START) == 0.);
+
+  const std::filesystem::path notes = "/home/user/notes.txt";
+  history.recordOpen(notes, START);
+  history.recordOpen(notes, START);
+  CHECK(history.size() == 1);
+  CHECK(getOpens(history, notes, START) == Catch::Approx(2.));
+
+  const auto halfLife = static_cast<int64_t>(OpenHistory::HALF_LIFE_DAYS * DAY);
+  CHECK(getOpens(history, notes, START + halfLife) == Catch::Approx(1.));
+  CHECK(getOpens(history, notes, START + 2 * halfLife) == Catch::Approx(.5));
+  // an open adds to what is left
+  history.recordOpen(notes, START + halfLife);
+  CHECK(getOpens(history, notes, START + halfLife) == Catch::Approx(2.));
+  // a clock set back does not make them grow
+  CHECK(getOpens(history, notes, START) == Catch::Approx(2.));
+  CHECK(history.getMaxOpens(START + halfLife) == Catch::Approx(2.));
+
+  SECTION("other paths of the same name were never opened") {
+    bool askedForPath = false;
+    CHECK(history.getOpens(
+            L"notes.txt",
+            [&askedForPath]() {
+              askedForPath = true;
+              return std::filesystem::path("/home/other/notes.txt");
+            },
+            START) == 0.);
+    CHECK(askedForPath);
+    // another name is rejected without assembling its path
+    askedForPath = false;
+    CHECK(history.getOpens(
+            L"todo.txt",
+            [&askedForPath]() {
+              askedForPath = true;
+              return std::filesystem::path("/home/user/todo.txt");
+            },
+            START) == 0.);
+    CHECK_FALSE(askedForPath);
+  }
+}
+
+TEST_CASE("The least opened record is dropped when the history is full") {
+  OpenHistory history;
+  const std::filesystem::path favourite = "/favourite.txt";
+  history.recordOpen(favourite, START);
+  history.recordOpen(favourite, START);
+  for (size_t i = 1; i < OpenHistory::MAX_RECORDS; ++i) {
+    history.recordOpen("/file_" + std::to_string(i), START + static_cast<int64_t>(i));
+  }
+  REQUIRE(history.size() == OpenHistory::MAX_RECORDS);
+
+  // the oldest of the single opens decayed the most
+  const int64_t now = START + DAY;
+  history.recordOpen("/new", now);
+  CHECK(history.size() == OpenHistory::MAX_RECORDS);
+  CHECK(getOpens(history, "/new", now) == Catch::Approx(1.));
+  CHECK(getOpens(history, "/file_1", now) == 0.);
+  CHECK(getOpens(history, "/file_2", now) > 0.);
+  CHECK(getOpens(history, favourite, now) > 1.);
+}
+
+TEST_CASE("The open history is read as written") {
+  OpenHistory history;
+  history.recordOpen("/a/one.txt", START);
+  history.recordOpen("/b/one.txt", START + DAY);
+  history.recordOpen("/b/one.txt", START + DAY);
+  history.recordOpen("/c/two.txt", START + 2 * DAY);
+
+  BinaryWriter writer;
+  history.serialize(writer);
+  BinaryReader reader(writer.getBuffer().data(), writer.size());
+  OpenHistory read;
+  read.deserialize(reader);
+  CHECK(read.size() == history.size());
+  const int64_t now = START + 3 * DAY;
+  for (const char* path : {"/a/one.txt", "/b/one.txt", "/c/two.txt", "/d/one.txt"}) {
+    CHECK(getOpens(read, path, now) == Catch::Approx(getOpens(history, path, now)));
+  }
+
+  SECTION("another version is rejected") {
+    BinaryWriter other;
+    other.writePod(OpenHistory::FORMAT_VERSION + 1);
+    other.writeVarint(0);
+    BinaryReader otherReader(other.getBuffer().data(), other.size());
+    OpenHistory rejected;
+    CHECK_THROWS_AS(rejected.deserialize(otherReader), std::runtime_error);
+  }
+
+  SECTION("invalid counts are rejected") {
+    BinaryWriter corrupted;
+    corrupted.writePod(OpenHistory::FORMAT_VERSION);
+    corrupted.writeVarint(1);
+    corrupted.writePod(uint64_t{1});
+    corrupted.writePod(uint64_t{2});
+    corrupted.writePod(-1.);
+    corrupted.writePod(START);
+    BinaryReader corruptedReader(corrupted.getBuffer().data(), corrupted.size());
+    OpenHistory rejected;
+    CHECK_THROWS_AS(rejected.deserialize(corruptedReader), std::runtime_error);
+  }
+}
+
+TEST_CASE("The bonus of opened results grows slowly and is capped") {
+  CHECK(Finder::getOpenBonus(0.) == 0);
+  CHECK(Finder::getOpenBonus(-1.) == 0);
+  // one well matching character for the first open
+  CHECK(Finder::getOpenBonus(1.) == Dictionary::MAX_CHAR_SCORE);
+  int previous = 0;
+  for (double opens = .25; opens < 1e6; opens *= 2.) {
+    const int bonus = Finder::getOpenBonus(opens);
+    CHECK(bonus >= previous);
+    CHECK(bonus <= Finder::MAX_OPEN_BONUS);
+    previous = bonus;
+  }
+  CHECK(previous == Finder::MAX_OPEN_BONUS);
+}
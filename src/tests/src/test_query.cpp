@@ -0,0 +1,154 @@
+#include <finder/Dictionary.h>
+#include <finder/Query.h>
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+// exact needles, fuzzy ones are the tree's business
+Query parseQuery(const std::wstring& text) {
+  return Query::parse(text, [](const size_t) { return size_t(0); });
+}
+
+void addPaths(Dictionary& dictionary) {
+  for (const std::wstring folder : {L"/data/src",
+                                    L"/data/src/linux",
+                                    L"/data/src/linux/usb",
+                                    L"/data/src/linux/net",
+                                    L"/data/src/boost",
+                                    L"/data/docs",
+                                    L"/data/docs/linux"}) {
+    dictionary.addPath(folder, true);
+  }
+  for (const std::wstring file : {L"/data/src/linux/usb/core.c",
+                                  L"/data/src/linux/usb/hub.c",
+                                  L"/data/src/linux/net/core.c",
+                                  L"/data/src/boost/asio.hpp",
+                                  L"/data/docs/linux/readme.txt"}) {
+    dictionary.addPath(file, false);
+  }
+}
+
+std::set<std::wstring> searchPaths(const Dictionary& dictionary, const std::wstring& text) {
+  std::atomic<bool> stop = false;
+  std::vector<EntryId> matches;
+  dictionary.searchQuery(stop, parseQuery(text), Dictionary::NO_WILDCARD, matches);
+  std::set<std::wstring> paths;
+  for (const EntryId id : matches) {
+    paths.insert(dictionary.getPath(id).wstring());
+  }
+  CHECK(paths.size() == matches.size());  // every match once
+  return paths;
+}
+
+void checkQueries(const Dictionary& dictionary) {
+  using Paths = std::set<std::wstring>;
+  CHECK(searchPaths(dictionary, L"linux/usb") == Paths{L"/data/src/linux/usb"});
+  CHECK(searchPaths(dictionary, L"linux/usb/") ==
+        Paths{L"/data/src/linux/usb/core.c", L"/data/src/linux/usb/hub.c"});
+  CHECK(searchPaths(dictionary, L"linux/") ==
+        Paths{L"/data/src/linux/usb", L"/data/src/linux/net", L"/data/docs/linux/readme.txt"});
+  // the other term on a folder above
+  CHECK(searchPaths(dictionary, L"usb core") == Paths{L"/data/src/linux/usb/core.c"});
+  CHECK(searchPaths(dictionary, L"core linux") ==
+        Paths{L"/data/src/linux/usb/core.c", L"/data/src/linux/net/core.c"});
+  // the content of a folder and everything below it
+  CHECK(searchPaths(dictionary, L"src/ asio") == Paths{L"/data/src/boost/asio.hpp"});
+  CHECK(searchPaths(dictionary, L"docs/ asio").empty());
+  CHECK(searchPaths(dictionary, L"linux docs") == Paths{L"/data/docs/linux"});
+  // every term has to match, one on the entry itself
+  CHECK(searchPaths(dictionary, L"docs readme usb").empty());
+  CHECK(searchPaths(dictionary, L"nowhere").empty());
+}
+
+}  // namespace
+
+TEST_CASE("Queries are split into terms and path segments") {
+  const Query query = Query::parse(L"  finder/tree   Dictionary ",
+                                   [](const size_t length) { return length >= 5 ? 1 : 0; });
+  REQUIRE(query.terms.size() == 2);
+  REQUIRE(query.terms[0].size() == 2);
+  CHECK(query.terms[0][0].needle == L"finder");
+  CHECK(query.terms[0][0].numFuzzyReplacements == 1);
+  CHECK(query.terms[0][1].needle == L"tree");
+  CHECK(query.terms[0][1].numFuzzyReplacements == 0);
+  REQUIRE(query.terms[1].size() == 1);
+  CHECK(query.terms[1][0].needle == L"Dictionary");
+  CHECK_FALSE(query.isSimple());
+
+  SECTION("empty segments are dropped, an empty last one lists the content") {
+    const Query content = parseQuery(L"/src//finder/");
+    REQUIRE(content.terms.size() == 1);
+    REQUIRE(content.terms[0].size() == 3);
+    CHECK(content.terms[0][0].needle == L"src");
+    CHECK(content.terms[0][1].needle == L"finder");
+    CHECK(content.terms[0][2].needle.empty());
+    CHECK(parseQuery(L"/ //").terms.empty());
+  }
+
+  SECTION("a single word is a simple query") {
+    const Query simple = parseQuery(L"tree");
+    CHECK(simple.isSimple());
+    CHECK(simple.getSimpleSegment().needle == L"tree");
+    CHECK(parseQuery(L"").isSimple());
+    CHECK(parseQuery(L"").getSimpleSegment().needle.empty());
+  }
+
+  SECTION("more than MAX_TERMS terms are ignored") {
+    std::wstring text;
+    for (size_t i = 0; i < Query::MAX_TERMS + 10; ++i) {
+      text += L"t" + std::to_wstring(i) + L" ";
+    }
+    CHECK(parseQuery(text).terms.size() == Query::MAX_TERMS);
+  }
+}
+
+TEST_CASE("Query terms match the entries and the folders above") {
+  Dictionary dictionary;
+  addPaths(dictionary);
+  dictionary.finalize(true);
+  checkQueries(dictionary);
+
+  SECTION("the folder content is found in a loaded index as well") {
+    const auto file = std::filesystem::temp_directory_path() / "fscout_test_query.idx";
+    REQUIRE(dictionary.serialize(file, std::chrono::steady_clock::now()));
+    Dictionary loaded;
+    std::chrono::steady_clock::time_point time;
+    loaded.deserialize(file, &time);
+    std::filesystem::remove(file);
+    checkQueries(loaded);
+  }
+}
+
+TEST_CASE("Queries with many candidates join the terms") {
+  // more matches of every term than are checked one by one
+  Dictionary dictionary;
+  addPaths(dictionary);
+  constexpr size_t NUM_FILES = 40000;
+  for (size_t folder = 0; folder < NUM_FILES / 100; ++folder) {
+    const std::wstring path = L"/big/part_" + std::to_wstring(folder);
+    dictionary.addPath(path, true);
+    for (size_t file = 0; file < 100; ++file) {
+      dictionary.addPath(path + L"/item_" + std::to_wstring(folder * 100 + file) + L".dat", false);
+    }
+  }
+  dictionary.finalize(true);
+
+  CHECK(searchPaths(dictionary, L"item dat").size() == NUM_FILES);
+  CHECK(searchPaths(dictionary, L"part item").size() == NUM_FILES);
+  // the selective term first, the other one is checked on its few matches
+  CHECK(searchPaths(dictionary, L"dat item_12345") == std::set<std::wstring>{
+                                                       L"/big/part_123/item_12345.dat"});
+  CHECK(searchPaths(dictionary, L"part_377/").size() == 100);
+  CHECK(searchPaths(dictionary, L"part_377/ item_377").size() == 100);
+  CHECK(searchPaths(dictionary, L"part_377/ item_37799").size() == 1);
+  CHECK(searchPaths(dictionary, L"usb core") ==
+        std::set<std::wstring>{L"/data/src/linux/usb/core.c"});
+}
@@ -0,0 +1,136 @@
+#include <finder/ResultUpdate.h>
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// what a receiver does with the changes, false if one does not fit
+bool applyChanges(const std::vector<ResultChange>& changes, std::vector<EntryId>& ranking) {
+  for (const ResultChange& change : changes) {
+    if (!fitsResults(change, ranking.size())) {
+      return false;
+    }
+    applyResultChange(change, ranking);
+  }
+  return true;
+}
+
+void checkRoundTrip(const std::vector<EntryId>& from, const std::vector<EntryId>& to) {
+  std::vector<ResultChange> changes;
+  REQUIRE(diffResults(from, to, std::numeric_limits<size_t>::max(), changes));
+  std::vector<EntryId> ranking = from;
+  REQUIRE(applyChanges(changes, ranking));
+  CHECK(ranking == to);
+}
+
+}  // namespace
+
+TEST_CASE("Result changes turn the old ranking into the new one") {
+  SECTION("empty rankings") {
+    std::vector<ResultChange> changes;
+    CHECK(diffResults({}, {}, 0, changes));
+    CHECK(changes.empty());
+    checkRoundTrip({}, {1, 2, 3});
+    checkRoundTrip({1, 2, 3}, {});
+  }
+
+  SECTION("unchanged ranking needs no changes") {
+    std::vector<ResultChange> changes;
+    CHECK(diffResults({4, 5, 6}, {4, 5, 6}, 0, changes));
+    CHECK(changes.empty());
+  }
+
+  SECTION("neighbouring rows are inserted and removed together") {
+    std::vector<ResultChange> changes;
+    REQUIRE(diffResults({1, 2, 3, 4, 5}, {1, 4, 5, 6, 7}, 10, changes));
+    REQUIRE(changes.size() == 2);
+    CHECK(changes[0].type == ResultChange::Type::REMOVE);
+    CHECK(changes[0].position == 1);
+    CHECK(changes[0].count == 2);
+    CHECK(changes[1].type == ResultChange::Type::INSERT);
+    CHECK(changes[1].position == 3);
+    CHECK(changes[1].ids == std::vector<EntryId>{6, 7});
+  }
+
+  SECTION("a row moving up is a single move") {
+    std::vector<ResultChange> changes;
+    REQUIRE(diffResults({1, 2, 3, 4}, {4, 1, 2, 3}, 10, changes));
+    REQUIRE(changes.size() == 1);
+    CHECK(changes[0].type == ResultChange::Type::MOVE);
+    CHECK(changes[0].position == 3);
+    CHECK(changes[0].target == 0);
+    checkRoundTrip({1, 2, 3, 4}, {4, 1, 2, 3});
+    checkRoundTrip({1, 2, 3, 4}, {2, 3, 4, 1});
+    checkRoundTrip({1, 2, 3, 4}, {4, 3, 2, 1});
+  }
+
+  SECTION("too many changes ask for the whole ranking") {
+    std::vector<ResultChange> changes;
+    CHECK_FALSE(diffResults({1, 2, 3, 4}, {4, 3, 2, 1}, 1, changes));
+  }
+
+  SECTION("random rankings") {
+    std::mt19937 random(7);
+    std::vector<EntryId> pool(200);
+    std::iota(pool.begin(), pool.end(), 0);
+    for (int i = 0; i < 200; ++i) {
+      std::shuffle(pool.begin(), pool.end(), random);
+      const std::vector<EntryId> from(pool.begin(), pool.begin() + random() % 60);
+      // mostly the same results, some new, in a slightly different order
+      std::vector<EntryId> to = from;
+      to.erase(std::remove_if(to.begin(), to.end(), [&](EntryId) { return random() % 5 == 0; }),
+               to.end());
+      to.insert(to.end(), pool.begin() + 60, pool.begin() + 60 + random() % 20);
+      for (size_t swaps = random() % 4; swaps > 0 && to.size() > 1; --swaps) {
+        std::swap(to[random() % to.size()], to[random() % to.size()]);
+      }
+      checkRoundTrip(from, to);
+    }
+  }
+}
+
+TEST_CASE("Result changes that do not fit are rejected") {
+  const std::vector<EntryId> ranking = {1, 2, 3};
+  CHECK(fitsResults({ResultChange::Type::INSERT, 3, 0, 0, {4}}, ranking.size()));
+  CHECK_FALSE(fitsResults({ResultChange::Type::INSERT, 4, 0, 0, {4}}, ranking.size()));
+  CHECK(fitsResults({ResultChange::Type::REMOVE, 1, 2, 0, {}}, ranking.size()));
+  CHECK_FALSE(fitsResults({ResultChange::Type::REMOVE, 2, 2, 0, {}}, ranking.size()));
+  // a corrupted count must not wrap around
+  CHECK_FALSE(fitsResults({ResultChange::Type::REMOVE, 1, ~size_t(0), 0, {}}, ranking.size()));
+  CHECK(fitsResults({ResultChange::Type::MOVE, 2, 0, 0, {}}, ranking.size()));
+  CHECK_FALSE(fitsResults({ResultChange::Type::MOVE, 3, 0, 0, {}}, ranking.size()));
+  CHECK_FALSE(fitsResults({ResultChange::Type::MOVE, 0, 0, 3, {}}, ranking.size()));
+}
+
+TEST_CASE("Rows other than ids follow the same changes") {
+  std::vector<std::string> paths = {"/a", "/b", "/c"};
+  applyResultChange({ResultChange::Type::INSERT, 1, 0, 0, {}},
+                    paths,
+                    std::vector<std::string>{"/x", "/y"});
+  CHECK(paths == std::vector<std::string>{"/a", "/x", "/y", "/b", "/c"});
+  applyResultChange({ResultChange::Type::MOVE, 4, 0, 0, {}}, paths, std::vector<std::string>());
+  CHECK(paths == std::vector<std::string>{"/c", "/a", "/x", "/y", "/b"});
+  applyResultChange({ResultChange::Type::REMOVE, 1, 3, 0, {}}, paths, std::vector<std::string>());
+  CHECK(paths == std::vector<std::string>{"/c", "/b"});
+}
+
+TEST_CASE("Changes only apply to the version they were computed against") {
+  ResultUpdate update;
+  update.baseVersion = 3;
+  update.version     = 4;
+  update.reset       = false;
+  CHECK(update.appliesTo(3));
+  // the receiver missed an update, or shows the results of another search
+  CHECK_FALSE(update.appliesTo(2));
+  CHECK_FALSE(update.appliesTo(4));
+  CHECK_FALSE(update.appliesTo(0));
+
+  update.reset = true;
+  CHECK_FALSE(update.appliesTo(3));
+}